@@ -1,83 +1,4 @@
-#include <QWidget>
-
-#include <QPointF>
-#include "elementlist.h"
-#include "laplace/laplace.h"
-
-class PCBView : public QWidget
-{
-    Q_OBJECT
-public:
-    explicit PCBView(QWidget *parent = nullptr);
-
-    void setCorners(QPointF topLeft, QPointF bottomRight);
-    void setElementList(ElementList *list);
-    void setLaplace(Laplace *laplace);
-
-    void startAppending(Element *e);
-    void setGrid(double grid);
-    void setShowGrid(bool show);
-    void setSnapToGrid(bool snap);
-    void setShowPotential(bool show);
-    void setKeepAspectRatio(bool keep);
-
-    QPointF getTopLeft() const;
-
-    QPointF getBottomRight() const;
-
-signals:
-
-protected:
-    void paintEvent(QPaintEvent *event) override;
-    void mousePressEvent(QMouseEvent *event) override;
-    void mouseReleaseEvent(QMouseEvent *event) override;
-    void mouseMoveEvent(QMouseEvent *event) override;
-    void mouseDoubleClickEvent(QMouseEvent *event) override;
-    void contextMenuEvent(QContextMenuEvent *event) override;
-private:
-    static const QColor backgroundColor;
-    static const QColor GNDColor;
-    static const QColor tracePosColor;
-    static const QColor traceNegColor;
-    static const QColor dielectricColor;
-    static const QColor gridColor;
-    static constexpr int vertexSize = 10;
-    static constexpr int vertexCatchRadius = 15;
-    double getPixelDistanceToVertex(QPoint cursor, QPointF vertex);
-    void someElementChanged();
-
-    using VertexInfo = struct {
-        Element *e;
-        int index;
-    };
-    VertexInfo catchVertex(QPoint cursor);
-
-    using LineInfo = struct {
-        Element *e;
-        int index1, index2;
-    };
-    LineInfo catchLine(QPoint cursor);
-
-    QPointF topLeft;
-    QPointF bottomRight;
-    QTransform transform;
-    ElementList *list;
-    Laplace *laplace;
-
-    Element *appendElement;
-    VertexInfo dragVertex;
-
-    QPoint pressCoords;
-    QPoint lastMouseCoords;
-    bool pressCoordsValid;
-
-    QPointF snapToGridPoint(const QPointF &pos);
-    double grid;
-    bool showGrid;
-    bool snapToGrid;
-    bool showPotential;
-    bool keepAspectRatio;
-};
+#include "pcbview.h"
 
 #include <QPainter>
 #include <QMouseEvent>
@@ -88,8 +9,6 @@ private:
 #include "ui_vertexEditDialog.h"
 #include "util.h"
 
-#include "polygon.h"
-
 const QColor PCBView::backgroundColor = Qt::lightGray;
 const QColor PCBView::GNDColor = Qt::black;
 const QColor PCBView::tracePosColor = Qt::red;
@@ -112,6 +31,7 @@ PCBView::PCBView(QWidget *parent)
     showGrid = false;
     snapToGrid = false;
     showPotential = false;
+    showField = false;
     keepAspectRatio = true;
 }
 
@@ -160,6 +80,12 @@ void PCBView::setShowPotential(bool show)
     update();
 }
 
+void PCBView::setShowField(bool show)
+{
+    showField = show;
+    update();
+}
+
 void PCBView::setKeepAspectRatio(bool keep)
 {
     keepAspectRatio = keep;
@@ -197,7 +123,23 @@ void PCBView::paintEvent(QPaintEvent *event)
 
     // show potential field
     // TODO make this optional
-    if(showPotential && laplace && laplace->isResultReady()) {
+    if(showField && laplace && laplace->isResultReady()) {
+        // the field is very strong at the conductor edges, scale relative to the mean field instead of the maximum
+        auto mean = laplace->getMeanFieldStrength();
+        for(int i=0;i<width();i++) {
+            for(int j=0;j<height();j++) {
+                auto coord = transform.inverted().map(QPointF(i, j));
+                auto e = laplace->getFieldStrength(coord);
+                if(std::isnan(e)) {
+                    continue;
+                }
+                auto intensity = e / (e + mean);
+                p.setPen(Util::getIntensityGradeColor(intensity));
+                p.setOpacity(sqrt(intensity));
+                p.drawPoint(i, j);
+            }
+        }
+    } else if(showPotential && laplace && laplace->isResultReady()) {
         for(int i=0;i<width();i++) {
             for(int j=0;j<height();j++) {
                 auto coord = transform.inverted().map(QPointF(i, j));
@@ -256,6 +198,10 @@ void PCBView::paintEvent(QPaintEvent *event)
                             // we are appending to this element, do not draw last line in polygon
                             continue;
                         }
+                        if(e->isLine()) {
+                            // open polyline, no connection from the last to the first vertex
+                            continue;
+                        }
                         prev = vertices.size() -  1;
                     }
                     QPointF start = transform.map(vertices[i]);
@@ -484,6 +430,9 @@ PCBView::LineInfo PCBView::catchLine(QPoint cursor)
         for(unsigned int i=0;i<e->getVertices().size();i++) {
             int prev = (int) i - 1;
             if(prev < 0) {
+                if(e->isLine()) {
+                    continue;
+                }
                 prev = e->getVertices().size() - 1;
             }
             QPointF vertexPixel1 = transform.map(e->getVertices()[i]).toPoint();
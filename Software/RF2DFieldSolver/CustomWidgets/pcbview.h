@@ -22,6 +22,7 @@ public:
     void setShowGrid(bool show);
     void setSnapToGrid(bool snap);
     void setShowPotential(bool show);
+    void setShowField(bool show);
     void setKeepAspectRatio(bool keep);
 
     QPointF getTopLeft() const;
@@ -79,6 +80,7 @@ private:
     bool showGrid;
     bool snapToGrid;
     bool showPotential;
+    bool showField;
     bool keepAspectRatio;
 };
 
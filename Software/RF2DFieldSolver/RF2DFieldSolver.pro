@@ -2,12 +2,15 @@ QT       += core gui
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
-CONFIG += c++11
+CONFIG += c++17
 
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# the Qt-free solver core
+include(core/core.pri)
+
 SOURCES += \
     CustomWidgets/informationbox.cpp \
     CustomWidgets/pcbview.cpp \
@@ -24,13 +27,14 @@ SOURCES += \
     element.cpp \
     elementlist.cpp \
     gauss/gauss.cpp \
+    goalseek.cpp \
     laplace/laplace.cpp \
-    laplace/lattice.c \
-    laplace/worker.c \
     main.cpp \
     mainwindow.cpp \
-    polygon.cpp \
+    montecarlo.cpp \
     savable.cpp \
+    surrogate.cpp \
+    sweep.cpp \
     unit.cpp \
     util.cpp
 
@@ -50,22 +54,25 @@ HEADERS += \
     element.h \
     elementlist.h \
     gauss/gauss.h \
+    goalseek.h \
     json.hpp \
     laplace/laplace.h \
-    laplace/lattice.h \
-    laplace/tuple.h \
-    laplace/worker.h \
     mainwindow.h \
-    polygon.h \
+    montecarlo.h \
     qpointervariant.h \
     savable.h \
+    surrogate.h \
+    sweep.h \
     unit.h \
     util.h
 
 FORMS += \
     CustomWidgets/vertexEditDialog.ui \
     Scenarios/scenario.ui \
-    mainwindow.ui
+    goalSeekDialog.ui \
+    mainwindow.ui \
+    monteCarloDialog.ui \
+    sweepDialog.ui
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
@@ -2,6 +2,7 @@
 #include "ui_scenario.h"
 
 #include "CustomWidgets/siunitedit.h"
+#include "unit.h"
 
 #include "microstrip.h"
 #include "stripline.h"
@@ -27,9 +28,7 @@ Scenario::Scenario(QWidget *parent) :
             auto entry = static_cast<SIUnitEdit*>(layout->itemAt(i, QFormLayout::FieldRole)->widget());
             *parameters[i].value = entry->value();
         }
-
-        auto list = createScenario();
-        emit scenarioCreated(QPointF(ui->xleft->value(), ui->ytop->value()), QPointF(ui->xright->value(), ui->ybottom->value()), list);
+        apply();
         accept();
     });
     ui->autoArea->setChecked(true);
@@ -73,10 +72,173 @@ QList<Scenario *> Scenario::createAll()
 
     for(auto s : ret) {
         s->setupParameters();
+        // tables built earlier
+        Surrogate table;
+        if(table.load(Surrogate::tableFilename(s->getName()))) {
+            s->setSurrogate(table);
+        }
     }
     return ret;
 }
 
+QStringList Scenario::getParameterNames()
+{
+    QStringList names;
+    for(auto &p : parameters) {
+        names.append(p.name);
+    }
+    return names;
+}
+
+QStringList Scenario::getParameterUnits()
+{
+    QStringList units;
+    for(auto &p : parameters) {
+        units.append(p.unit);
+    }
+    return units;
+}
+
+QVector<double> Scenario::getParameterValues()
+{
+    QVector<double> values;
+    for(auto &p : parameters) {
+        values.append(*p.value);
+    }
+    return values;
+}
+
+void Scenario::setParameterValues(const QVector<double> &values)
+{
+    auto layout = static_cast<QFormLayout*>(ui->parameters->layout());
+    for(unsigned int i=0;i<parameters.size() && i<values.size();i++) {
+        *parameters[i].value = values[i];
+        // keep the dialog in sync
+        auto item = layout->itemAt(i, QFormLayout::FieldRole);
+        if(item) {
+            static_cast<SIUnitEdit*>(item->widget())->setValue(values[i]);
+        }
+    }
+}
+
+ElementList *Scenario::create(QPointF &topLeft, QPointF &bottomRight, bool adjustArea)
+{
+    bool autoArea = ui->autoArea->isChecked();
+    if(!adjustArea) {
+        // keep the given area
+        ui->autoArea->setChecked(false);
+        ui->xleft->setValue(topLeft.x());
+        ui->xright->setValue(bottomRight.x());
+        ui->ytop->setValue(topLeft.y());
+        ui->ybottom->setValue(bottomRight.y());
+    } else {
+        ui->autoArea->setChecked(true);
+    }
+    auto list = createScenario();
+    ui->autoArea->setChecked(autoArea);
+    topLeft = QPointF(ui->xleft->value(), ui->ytop->value());
+    bottomRight = QPointF(ui->xright->value(), ui->ybottom->value());
+    return list;
+}
+
+void Scenario::growArea(const QVector<QVector<double>> &parameterSets, QPointF &topLeft, QPointF &bottomRight)
+{
+    auto values = getParameterValues();
+    for(auto &p : parameterSets) {
+        setParameterValues(p);
+        QPointF tl, br;
+        auto l = create(tl, br, true);
+        while(l->getElements().size()) {
+            l->removeElement(0);
+        }
+        delete l;
+        topLeft = QPointF(std::min(topLeft.x(), tl.x()), std::max(topLeft.y(), tl.y()));
+        bottomRight = QPointF(std::max(bottomRight.x(), br.x()), std::min(bottomRight.y(), br.y()));
+    }
+    setParameterValues(values);
+}
+
+QVector<ElementList*> Scenario::create(const QVector<QVector<double>> &parameterSets, QPointF &topLeft, QPointF &bottomRight)
+{
+    growArea(parameterSets, topLeft, bottomRight);
+    auto values = getParameterValues();
+    QVector<ElementList*> lists;
+    for(auto &p : parameterSets) {
+        setParameterValues(p);
+        auto tl = topLeft;
+        auto br = bottomRight;
+        lists.append(create(tl, br, false));
+    }
+    setParameterValues(values);
+    return lists;
+}
+
+void Scenario::apply()
+{
+    QPointF topLeft(ui->xleft->value(), ui->ytop->value());
+    QPointF bottomRight(ui->xright->value(), ui->ybottom->value());
+    auto list = create(topLeft, bottomRight, ui->autoArea->isChecked());
+    emit scenarioCreated(topLeft, bottomRight, list);
+}
+
+void Scenario::setSurrogate(const Surrogate &surrogate)
+{
+    this->surrogate = surrogate;
+    updatePrediction();
+}
+
+void Scenario::setSolverSettings(const Surrogate::Settings &settings)
+{
+    solverSettings = settings;
+    updatePrediction();
+}
+
+void Scenario::updatePrediction()
+{
+    if(surrogate.isEmpty()) {
+        ui->prediction->hide();
+        return;
+    }
+    ui->prediction->show();
+    if(surrogate.getSettings() != solverSettings) {
+        ui->prediction->setText("The surrogate table was built with other solver settings or another area, build it again for predictions");
+        return;
+    }
+    // the values as they are typed, the entries only update them when editing is finished
+    auto layout = static_cast<QFormLayout*>(ui->parameters->layout());
+    QVector<double> values;
+    for(unsigned int i=0;i<parameters.size();i++) {
+        auto entry = static_cast<SIUnitEdit*>(layout->itemAt(i, QFormLayout::FieldRole)->widget());
+        double value = entry->value();
+        if(!entry->text().isEmpty()) {
+            auto typed = Unit::FromString(entry->text(), parameters[i].unit, parameters[i].prefixes);
+            if(!std::isnan(typed)) {
+                value = typed;
+            }
+        }
+        values.append(value);
+    }
+    Surrogate::Prediction prediction;
+    if(!surrogate.predict(values, prediction)) {
+        ui->prediction->setText("Outside of the surrogate table, the impedance is calculated after creating the elements");
+        return;
+    }
+    auto &p = prediction.parameters;
+    auto Z = [](double value) -> QString {
+        return Unit::ToString(value, "Ω", " ", 4);
+    };
+    QString text = "Predicted: ";
+    if(!std::isnan(p.modes.differential)) {
+        text += "Zdiff = "+Z(p.modes.differential)+", Zodd = "+Z(p.modes.odd)+", Zeven = "+Z(p.modes.even)+", Zcomm = "+Z(p.modes.common);
+    } else if(!std::isnan(p.impedanceP)) {
+        text += "Z = "+Z(p.impedanceP);
+    } else {
+        text += "Z = "+Z(p.impedanceN);
+    }
+    text += " (±"+QString::number(prediction.error * 100, 'g', 2)+"%)";
+    ui->prediction->setText(text);
+}
+
 void Scenario::setupParameters()
 {
     auto layout = static_cast<QFormLayout*>(ui->parameters->layout());
@@ -85,7 +247,10 @@ void Scenario::setupParameters()
         auto entry = new SIUnitEdit(p.unit, p.prefixes, p.precision);
         entry->setValue(*p.value);
         layout->addRow(label, entry);
+        connect(entry, &SIUnitEdit::valueChanged, this, &Scenario::updatePrediction);
+        connect(entry, &QLineEdit::textEdited, this, &Scenario::updatePrediction);
     }
+    updatePrediction();
     setWindowTitle(name + " Setup Dialog");
 
     // show the image
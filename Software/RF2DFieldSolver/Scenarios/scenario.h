@@ -4,8 +4,10 @@
 #include <QDialog>
 #include <QList>
 #include <QRectF>
+#include <QVector>
 
 #include "elementlist.h"
+#include "surrogate.h"
 
 namespace Ui {
 class Scenario;
@@ -24,6 +26,26 @@ public:
     void setupParameters();
     const QString &getName() const { return name; }
 
+    // parameters of the scenario (as shown in the dialog), e.g. for sensitivities
+    QStringList getParameterNames();
+    QStringList getParameterUnits();
+    QVector<double> getParameterValues();
+    void setParameterValues(const QVector<double> &values);
+    // creates the elements for the current parameter values, the area is only adjusted to them if requested
+    ElementList *create(QPointF &topLeft, QPointF &bottomRight, bool adjustArea);
+    // grows the area until the elements of all parameter sets fit into it, the parameter values are kept
+    void growArea(const QVector<QVector<double>> &parameterSets, QPointF &topLeft, QPointF &bottomRight);
+    // creates the elements of all parameter sets with one area (grown from the given one) that fits all of them, as
+    // needed by the warm start of a sweep. The parameter values are kept
+    QVector<ElementList*> create(const QVector<QVector<double>> &parameterSets, QPointF &topLeft, QPointF &bottomRight);
+    // creates the elements for the current parameter values with the area of the dialog, same as accepting the dialog
+    void apply();
+    // table of the line parameters, the dialog shows the predicted impedances while the parameters are edited
+    void setSurrogate(const Surrogate &surrogate);
+    const Surrogate &getSurrogate() const { return surrogate; }
+    // the current solver settings, the prediction is only shown if the table was built with them
+    void setSolverSettings(const Surrogate::Settings &settings);
+
 signals:
     void scenarioCreated(QPointF topLeft, QPointF bottomRight, ElementList *list);
 
@@ -42,5 +64,8 @@ protected:
     QString name;
     Ui::Scenario *ui;
 private:
+    void updatePrediction();
+    Surrogate surrogate;
+    Surrogate::Settings solverSettings;
     };
 #endif // SCENARIO_H
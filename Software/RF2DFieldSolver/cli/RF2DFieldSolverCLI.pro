@@ -0,0 +1,32 @@
+QT       += core gui widgets
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = RF2DFieldSolverCLI
+
+# the solver sources are shared with the GUI, the core is the same library
+INCLUDEPATH += ..
+include(../core/core.pri)
+
+SOURCES += \
+    ../element.cpp \
+    ../elementlist.cpp \
+    ../gauss/gauss.cpp \
+    ../laplace/laplace.cpp \
+    ../util.cpp \
+    main.cpp
+
+HEADERS += \
+    ../element.h \
+    ../elementlist.h \
+    ../gauss/gauss.h \
+    ../json.hpp \
+    ../laplace/laplace.h \
+    ../savable.h \
+    ../util.h
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
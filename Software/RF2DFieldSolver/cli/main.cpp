@@ -0,0 +1,214 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+#include "elementlist.h"
+#include "laplace/laplace.h"
+
+// Headless calculation of a project file (as saved by the GUI), prints C/L/Z as JSON
+
+static bool verbose = false;
+
+static void message(QString type, QString text)
+{
+    std::cerr << type.toStdString() << ": " << text.toStdString() << std::endl;
+}
+
+static nlohmann::json matrixToJSON(const QVector<QVector<double>> &m)
+{
+    nlohmann::json j = nlohmann::json::array();
+    for(auto &row : m) {
+        j.push_back(std::vector<double>(row.begin(), row.end()));
+    }
+    return j;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("RF2DFieldSolverCLI");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Calculates capacitance, inductance and impedance of the traces in a project file");
+    parser.addHelpOption();
+    parser.addPositionalArgument("project", "Project file (.RF2Dproj)");
+    QCommandLineOption outputOption({"o", "output"}, "Write the result to <file> instead of the standard output", "file");
+    parser.addOption(outputOption);
+    QCommandLineOption threadsOption({"t", "threads"}, "Number of threads (default: all cores)", "threads");
+    parser.addOption(threadsOption);
+    QCommandLineOption verboseOption({"v", "verbose"}, "Print the progress messages of the solver");
+    parser.addOption(verboseOption);
+    parser.process(a);
+
+    if(parser.positionalArguments().size() != 1) {
+        parser.showHelp(1);
+    }
+    verbose = parser.isSet(verboseOption);
+    int threads = QThread::idealThreadCount();
+    if(parser.isSet(threadsOption)) {
+        threads = parser.value(threadsOption).toInt();
+        if(threads < 1) {
+            message("Error", "Invalid number of threads");
+            return 1;
+        }
+    }
+
+    // load the project
+    auto filename = parser.positionalArguments().first();
+    std::ifstream file;
+    file.open(filename.toStdString());
+    if(!file.is_open()) {
+        message("Error", "Unable to open file "+filename);
+        return 1;
+    }
+    nlohmann::json j;
+    try {
+        file >> j;
+    } catch (std::exception &e) {
+        message("Error", "Failed to parse the project file ("+QString(e.what())+")");
+        return 1;
+    }
+    file.close();
+
+    ElementList list;
+    if(j.contains("list")) {
+        list.fromJSON(j["list"]);
+    }
+    QString checkError;
+    QStringList checkWarnings;
+    bool valid = list.check(checkError, checkWarnings);
+    for(auto &w : checkWarnings) {
+        message("Warning", w);
+    }
+    if(!valid) {
+        message("Error", checkError);
+        return 1;
+    }
+
+    // same settings as the GUI, missing entries keep the defaults of the solver
+    Laplace laplace;
+    QObject::connect(&laplace, &Laplace::info, [](QString info) {
+        if(verbose) {
+            message("Info", info);
+        }
+    });
+    QObject::connect(&laplace, &Laplace::warning, [](QString warning) {
+        message("Warning", warning);
+    });
+    QObject::connect(&laplace, &Laplace::error, [](QString error) {
+        message("Error", error);
+    });
+    laplace.setArea(QPointF(j.value("xleft", -3e-3), j.value("ytop", 3e-3)), QPointF(j.value("xright", 3e-3), j.value("ybottom", -1e-3)));
+    double gridX = j.value("simulationGrid", 1e-5);
+    // older files only have one grid resolution for both directions
+    double gridY = j.value("simulationGridY", gridX);
+    laplace.setGrid(gridX, gridY);
+    laplace.setThreads(threads);
+    if(j.contains("tolerance")) {
+        laplace.setThreshold(j["tolerance"]);
+    }
+    laplace.setGroundedBorders(j.value("borderIsGND", true));
+    // older files were evaluated with the legacy discretization and solver, keep their results
+    auto averaging = Laplace::DielectricAveragingFromString(QString::fromStdString(j.value("dielectricAveraging",
+                                    Laplace::DielectricAveragingToString(Laplace::DielectricAveraging::CellCenter).toStdString())));
+    if(averaging == Laplace::DielectricAveraging::Last) {
+        averaging = Laplace::DielectricAveraging::CellCenter;
+    }
+    laplace.setDielectricAveraging(averaging);
+    laplace.setSubCellBoundaries(j.value("subCellBoundaries", false));
+    auto method = Laplace::MethodFromString(QString::fromStdString(j.value("method",
+                                    Laplace::MethodToString(Laplace::Method::GaussSeidel).toStdString())));
+    if(method == Laplace::Method::Last) {
+        method = Laplace::Method::GaussSeidel;
+    }
+    laplace.setMethod(method);
+    auto acceleration = Laplace::AccelerationFromString(QString::fromStdString(j.value("acceleration",
+                                    Laplace::AccelerationToString(Laplace::Acceleration::None).toStdString())));
+    if(acceleration == Laplace::Acceleration::Last) {
+        acceleration = Laplace::Acceleration::None;
+    }
+    laplace.setAcceleration(acceleration);
+    if(j.contains("andersonWindow")) {
+        laplace.setAndersonWindow(j["andersonWindow"]);
+    }
+    if(j.value("chargeConvergence", false)) {
+        laplace.setChargeConvergence(j.value("chargeTolerance", 0.0));
+    }
+    laplace.setTimeBudget(j.value("timeBudget", 0.0));
+    // older files were evaluated with the contour integration
+    auto chargeExtraction = Laplace::ChargeExtractionFromString(QString::fromStdString(j.value("chargeExtraction",
+                                    Laplace::ChargeExtractionToString(Laplace::ChargeExtraction::GaussContour).toStdString())));
+    if(chargeExtraction == Laplace::ChargeExtraction::Last) {
+        chargeExtraction = Laplace::ChargeExtraction::GaussContour;
+    }
+    laplace.setChargeExtraction(chargeExtraction);
+    bool conductorMatrix = j.value("conductorMatrix", false);
+    laplace.setMatrixExtraction(conductorMatrix);
+
+    QElapsedTimer timer;
+    timer.start();
+    nlohmann::json result;
+    auto nan = std::numeric_limits<double>::quiet_NaN();
+    double chargeAirP = nan, chargeAirN = nan;
+    if(!conductorMatrix && chargeExtraction == Laplace::ChargeExtraction::ConductorResidual && list.hasDielectric()) {
+        // the residual charges need a separate calculation without dielectric
+        laplace.setIgnoreDielectric(true);
+        if(!laplace.calculate(&list)) {
+            message("Error", "Air calculation failed");
+            return 1;
+        }
+        chargeAirP = laplace.getCharge(Element::Type::TracePos);
+        chargeAirN = -laplace.getCharge(Element::Type::TraceNeg);
+        laplace.setIgnoreDielectric(false);
+    }
+    if(!laplace.calculate(&list)) {
+        message("Error", "Calculation failed");
+        return 1;
+    }
+    if(conductorMatrix) {
+        auto conductors = laplace.getConductors();
+        result["conductors"] = std::vector<int>(conductors.begin(), conductors.end());
+        result["capacitanceMatrix"] = matrixToJSON(laplace.getCapacitanceMatrix());
+        result["inductanceMatrix"] = matrixToJSON(laplace.getInductanceMatrix());
+    }
+    auto p = laplace.getLineParameters(chargeAirP, chargeAirN);
+    result["capacitanceP"] = p.capacitanceP;
+    result["inductanceP"] = p.inductanceP;
+    result["impedanceP"] = p.impedanceP;
+    result["capacitanceN"] = p.capacitanceN;
+    result["inductanceN"] = p.inductanceN;
+    result["impedanceN"] = p.impedanceN;
+    auto modes = p.getModes();
+    result["impedanceDiff"] = modes.differential;
+    result["impedanceOdd"] = modes.odd;
+    result["impedanceEven"] = modes.even;
+    result["impedanceComm"] = modes.common;
+    auto error = laplace.getErrorEstimate();
+    if(!std::isnan(error)) {
+        result["errorEstimate"] = error;
+    }
+    result["threads"] = threads;
+    result["calculationTime"] = timer.elapsed() / 1000.0;
+
+    // not available values (e.g. without negative trace) are written as null
+    if(parser.isSet(outputOption)) {
+        std::ofstream out;
+        out.open(parser.value(outputOption).toStdString());
+        if(!out.is_open()) {
+            message("Error", "Unable to write "+parser.value(outputOption));
+            return 1;
+        }
+        out << std::setw(4) << result << std::endl;
+        out.close();
+    } else {
+        std::cout << std::setw(4) << result << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,32 @@
+# Solver core without Qt: geometry model, lattice construction, solvers and charge extraction.
+# The GUI and the command line tool include it directly, core.pro builds it as a library
+INCLUDEPATH += $$PWD
+# the sources use C++17 (e.g. std::clamp), every project including them needs it as well
+CONFIG += c++17
+
+SOURCES += \
+    $$PWD/engine.c \
+    $$PWD/fields.c \
+    $$PWD/geometry.cpp \
+    $$PWD/lattice.c \
+    $$PWD/matrix.cpp \
+    $$PWD/monitor.c \
+    $$PWD/polygon.cpp \
+    $$PWD/progressestimator.cpp \
+    $$PWD/solver.cpp \
+    $$PWD/worker.c
+
+HEADERS += \
+    $$PWD/engine.h \
+    $$PWD/fields.h \
+    $$PWD/geometry.h \
+    $$PWD/lattice.h \
+    $$PWD/matrix.h \
+    $$PWD/monitor.h \
+    $$PWD/polygon.h \
+    $$PWD/progressestimator.h \
+    $$PWD/solver.h \
+    $$PWD/tuple.h \
+    $$PWD/worker.h
+
+unix: LIBS += -lpthread
@@ -0,0 +1,17 @@
+# Standalone library of the solver core for other applications (links against nothing but pthreads).
+# Remove staticlib from the CONFIG to build a shared library instead
+TEMPLATE = lib
+CONFIG += staticlib
+CONFIG -= qt
+
+TARGET = RF2DFieldSolverCore
+
+include(core.pri)
+
+# Default rules for deployment.
+unix {
+    target.path = /usr/local/lib
+    headers.path = /usr/local/include/RF2DFieldSolver
+    headers.files = $$HEADERS
+    INSTALLS += target headers
+}
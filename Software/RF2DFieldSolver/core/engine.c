@@ -0,0 +1,850 @@
+#include <stdlib.h>
+#include <math.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "engine.h"
+
+/* number of plain sweeps used for estimating the spectral radius */
+#define ENGINE_CHEBYSHEV_ESTIMATE 12
+/* the first sweeps after a restart are not used for the estimation */
+#define ENGINE_CHEBYSHEV_SETTLE 4
+/* number of chebyshev sweeps after which the convergence is checked */
+#define ENGINE_CHEBYSHEV_CHECK 32
+/* number of sweeps between two anderson mixing steps */
+#define ENGINE_ANDERSON_PERIOD 4
+
+void* engine_work(void* ptr);
+double engine_sweep(struct engine_thread* thread);
+double engine_relax_colour(struct engine_thread* thread, uint32_t colour);
+double engine_relax_row(struct engine_thread* thread, uint32_t j);
+double engine_relax_row_fields(struct engine_thread* thread, uint32_t j);
+void engine_rows(struct engine_thread* thread, uint32_t* first, uint32_t* last);
+void engine_store(struct engine_thread* thread);
+double engine_extrapolate(struct engine_thread* thread);
+void engine_chebyshev_restart(struct engine* engine);
+double engine_chebyshev_bound(struct engine* engine);
+void engine_chebyshev_update(struct engine* engine, double diff);
+bool engine_anderson_new(struct engine* engine);
+void engine_anderson_delete(struct engine* engine);
+void engine_anderson(struct engine_thread* thread);
+void engine_anderson_solve(struct engine* engine);
+bool engine_quantity_converged(struct engine* engine);
+
+uint32_t engine_compute(struct lattice* lattice, struct config* conf, progress_callback_t cb, quantity_callback_t quantity, void *cb_ptr) {
+    return engine_compute_fields(lattice, NULL, 1, conf, cb, quantity, cb_ptr);
+}
+
+uint32_t engine_compute_fields(struct lattice* lattice, double* values, uint32_t fields, struct config* conf, progress_callback_t cb, quantity_callback_t quantity, void *cb_ptr) {
+    struct engine engine;
+    struct engine_thread* threads;
+    uint8_t count = conf->threads;
+    uint32_t w = lattice->dim.x;
+
+    /* make sure the number of threads is useful */
+    if(count < 1)
+        count = 1;
+    if(values == NULL || fields < 1)
+        fields = 1;
+
+    /* initialise the engine */
+    engine.lattice = lattice;
+    engine.values = values;
+    engine.fields = fields;
+    engine.conf = *conf;
+    engine.conf.threads = count;
+    engine.iterations = 0;
+    engine.done = false;
+    engine.cb = cb;
+    engine.quantity = quantity;
+    engine.cb_ptr = cb_ptr;
+    engine.quantities = NULL;
+    engine.evaluations = 0;
+    monitor_init(&engine.monitor);
+    engine.last = NULL;
+    engine.current = NULL;
+    engine.chebyshev.rho = 0;
+    engine_chebyshev_restart(&engine);
+    engine.anderson.x = NULL;
+    engine.anderson.f = NULL;
+    engine.anderson.dx = NULL;
+    engine.anderson.df = NULL;
+    engine.anderson.gram = NULL;
+    engine.anderson.gamma = NULL;
+    engine.anderson.partial = NULL;
+
+    /* the anderson mixing is only implemented for the values of the cells */
+    if(values != NULL && engine.conf.acceleration == ACCELERATION_ANDERSON)
+        engine.conf.acceleration = ACCELERATION_CHEBYSHEV;
+
+    engine.diffs = calloc(count, sizeof(double));
+    if(engine.diffs == NULL) goto ERROR1;
+
+    threads = calloc(count, sizeof(struct engine_thread));
+    if(threads == NULL) goto ERROR2;
+
+    if(engine.quantity == NULL)
+        engine.conf.interval = 0;
+    if(engine.conf.interval > 0) {
+        engine.quantities = calloc(engine.conf.span+1, sizeof(double));
+        if(engine.quantities == NULL) goto ERROR3;
+    }
+
+    if(engine.conf.acceleration == ACCELERATION_CHEBYSHEV) {
+        size_t m = (size_t) lattice->dim.x*lattice->dim.y*fields;
+        engine.last = malloc(m*sizeof(double));
+        engine.current = malloc(m*sizeof(double));
+        if(engine.last == NULL || engine.current == NULL) goto ERROR3;
+        for(size_t index = 0; index < m; index++)
+            engine.last[index] = values != NULL ? values[index] : lattice->cells[index].value;
+    }
+
+    if(engine.conf.acceleration == ACCELERATION_ANDERSON) {
+        if(!engine_anderson_new(&engine)) goto ERROR3;
+    }
+
+    if(pthread_mutex_init(&engine.start, NULL) != 0) goto ERROR3;
+
+    /* allocate the scratch buffers */
+    for(uint8_t t = 0; t < count; t++) {
+        threads[t].engine = &engine;
+        threads[t].id = t;
+        threads[t].c = malloc(w*sizeof(double));
+        threads[t].d = malloc((size_t) w*fields*sizeof(double));
+        if(threads[t].c == NULL || threads[t].d == NULL) goto ERROR4;
+    }
+
+    /*
+     * start the team, the calling thread is the first member. The other
+     * threads wait until the size of the team is known, if a thread can
+     * not be started the team continues with the ones that are running.
+     */
+    pthread_mutex_lock(&engine.start);
+    uint8_t started = 1;
+    for(uint8_t t = 1; t < count; t++) {
+        if(pthread_create(&threads[t].thread, NULL, &engine_work, (void*) &threads[t]) != 0)
+            break;
+        started++;
+    }
+    engine.conf.threads = started;
+    bool barrier = pthread_barrier_init(&engine.barrier, NULL, started) == 0;
+    if(!barrier)
+        engine.done = true;
+    pthread_mutex_unlock(&engine.start);
+
+    if(barrier)
+        engine_work(&threads[0]);
+    for(uint8_t t = 1; t < started; t++)
+        pthread_join(threads[t].thread, NULL);
+    if(barrier)
+        pthread_barrier_destroy(&engine.barrier);
+
+ERROR4:
+    for(uint8_t t = 0; t < count; t++) {
+        free(threads[t].c);
+        free(threads[t].d);
+    }
+    pthread_mutex_destroy(&engine.start);
+ERROR3:
+    free(engine.quantities);
+    engine_anderson_delete(&engine);
+    free(engine.last);
+    free(engine.current);
+    free(threads);
+ERROR2:
+    free(engine.diffs);
+ERROR1:
+    return engine.iterations;
+}
+
+void* engine_work(void* ptr) {
+    struct engine_thread* thread = (struct engine_thread*) ptr;
+    struct engine* engine = thread->engine;
+
+    /* wait until the team is complete */
+    pthread_mutex_lock(&engine->start);
+    pthread_mutex_unlock(&engine->start);
+    if(engine->done)
+        return NULL;
+
+    do {
+        engine->diffs[thread->id] = engine_sweep(thread);
+        pthread_barrier_wait(&engine->barrier);
+
+        /* the first thread evaluates the sweep while the others wait */
+        if(thread->id == 0) {
+            double diff = 0;
+            for(uint8_t t = 0; t < engine->conf.threads; t++)
+                if(engine->diffs[t] > diff) diff = engine->diffs[t];
+
+            engine->iterations++;
+            /* evaluated before the chebyshev parameters of the next sweep may reset the monitor */
+            enum result result = monitor_update(&engine->monitor, diff);
+            /* the plain sweeps estimating the spectral radius barely change the slowest modes, their
+               differences underestimate the error of a good initial value (e.g. a warm start) */
+            bool estimating = engine->conf.acceleration == ACCELERATION_CHEBYSHEV && engine->chebyshev.estimating;
+            if(engine->conf.acceleration == ACCELERATION_CHEBYSHEV)
+                engine_chebyshev_update(engine, diff);
+            if(engine->cb)
+                engine->cb(engine->cb_ptr, diff);
+
+            if((diff <= engine->conf.threshold && !estimating) || engine->lattice->abort)
+                engine->done = true;
+
+            /* give up if this is not going anywhere */
+            if(!engine->done && result != RESULT_NONE) {
+                engine->lattice->result = result;
+                engine->lattice->reached = engine->monitor.best;
+                engine->lattice->abort = true;
+                engine->done = true;
+            }
+
+            if(!engine->done
+            && engine->conf.interval > 0
+            && engine->iterations % engine->conf.interval == 0
+            && engine_quantity_converged(engine))
+                engine->done = true;
+        }
+        pthread_barrier_wait(&engine->barrier);
+
+        if(!engine->done
+        && engine->conf.acceleration == ACCELERATION_ANDERSON
+        && engine->iterations % ENGINE_ANDERSON_PERIOD == 0)
+            engine_anderson(thread);
+    } while(!engine->done);
+
+    return NULL;
+}
+
+double engine_sweep(struct engine_thread* thread) {
+    struct engine* engine = thread->engine;
+    double diff = 0;
+
+    if(engine->conf.acceleration == ACCELERATION_CHEBYSHEV) {
+        /* keep the current iterate, the sweep must be symmetric */
+        engine_store(thread);
+        pthread_barrier_wait(&engine->barrier);
+        engine_relax_colour(thread, 0);
+        engine_relax_colour(thread, 1);
+        engine_relax_colour(thread, 0);
+        return engine_extrapolate(thread);
+    }
+
+    /* even rows only depend on odd rows and vice versa */
+    for(uint32_t colour = 0; colour < 2; colour++) {
+        double check = engine_relax_colour(thread, colour);
+        if(check > diff) diff = check;
+    }
+
+    return diff;
+}
+
+/**
+ * This function relaxes this thread's share of the rows of one colour
+ * and waits for the other threads.
+ */
+double engine_relax_colour(struct engine_thread* thread, uint32_t colour) {
+    struct engine* engine = thread->engine;
+    uint32_t h = engine->lattice->dim.y;
+    uint8_t count = engine->conf.threads;
+    double diff = 0;
+
+    /* distribute the rows of this colour evenly across the threads */
+    uint32_t rows = (h-colour+1)/2;
+    uint32_t first = rows*thread->id/count;
+    uint32_t last = rows*(thread->id+1)/count;
+
+    for(uint32_t n = first; n < last; n++) {
+        double check = engine->values != NULL
+                     ? engine_relax_row_fields(thread, colour+2*n)
+                     : engine_relax_row(thread, colour+2*n);
+        if(check > diff) diff = check;
+    }
+    pthread_barrier_wait(&engine->barrier);
+
+    return diff;
+}
+
+/**
+ * This function computes the block of rows this thread is responsible
+ * for outside of the relaxation.
+ */
+void engine_rows(struct engine_thread* thread, uint32_t* first, uint32_t* last) {
+    uint32_t h = thread->engine->lattice->dim.y;
+    uint8_t count = thread->engine->conf.threads;
+
+    *first = h*thread->id/count;
+    *last = h*(thread->id+1)/count;
+}
+
+void engine_store(struct engine_thread* thread) {
+    struct engine* engine = thread->engine;
+    struct lattice* lattice = engine->lattice;
+    uint32_t w = lattice->dim.x;
+    uint32_t first, last;
+
+    engine_rows(thread, &first, &last);
+    if(engine->values != NULL) {
+        uint32_t n = engine->fields;
+        for(size_t k = (size_t) first*w*n; k < (size_t) last*w*n; k++)
+            engine->current[k] = engine->values[k];
+        return;
+    }
+    for(uint32_t index = first*w; index < last*w; index++)
+        engine->current[index] = lattice->cells[index].value;
+}
+
+/**
+ * This function combines the result of the symmetric sweep S(x) with
+ * the current and the previous iterate:
+ *
+ *     x' = omega*(gamma*(S(x)-x) + x - x_last) + x_last
+ *
+ * With omega = gamma = 1 this is the plain sweep.
+ */
+double engine_extrapolate(struct engine_thread* thread) {
+    struct engine* engine = thread->engine;
+    struct lattice* lattice = engine->lattice;
+    uint32_t w = lattice->dim.x;
+    double omega = engine->chebyshev.omega;
+    double gamma = engine->chebyshev.gamma;
+    double diff = 0;
+    uint32_t first, last;
+
+    engine_rows(thread, &first, &last);
+    if(engine->values != NULL) {
+        uint32_t n = engine->fields;
+        for(uint32_t index = first*w; index < last*w; index++) {
+            if(lattice->update[index] == NULL)
+                continue;
+
+            for(size_t k = (size_t) index*n; k < (size_t) (index+1)*n; k++) {
+                double x = engine->current[k];
+                double value = omega*(gamma*(engine->values[k]-x)+x-engine->last[k])+engine->last[k];
+
+                double check = fabs(value-x);
+                if(check > diff) diff = check;
+
+                engine->last[k] = x;
+                engine->values[k] = value;
+            }
+        }
+        return diff;
+    }
+    for(uint32_t index = first*w; index < last*w; index++) {
+        if(lattice->update[index] == NULL)
+            continue;
+
+        struct cell* cell = &lattice->cells[index];
+        double x = engine->current[index];
+        double value = omega*(gamma*(cell->value-x)+x-engine->last[index])+engine->last[index];
+
+        double check = fabs(value-x);
+        if(check > diff) diff = check;
+
+        engine->last[index] = x;
+        cell->value = value;
+    }
+
+    return diff;
+}
+
+/**
+ * This function restarts the estimation of the spectral radius with
+ * plain sweeps.
+ */
+void engine_chebyshev_restart(struct engine* engine) {
+    engine->chebyshev.estimating = true;
+    engine->chebyshev.step = 0;
+    engine->chebyshev.omega = 1;
+    engine->chebyshev.gamma = 1;
+}
+
+/**
+ * This function computes the upper bound of the spectral radius. The
+ * slowest mode spans the whole lattice, its eigenvalue is about 1-c/n^2
+ * for n cells along the longer side, with c well above 1 for the
+ * symmetric sweep.
+ */
+double engine_chebyshev_bound(struct engine* engine) {
+    double n = engine->lattice->dim.x > engine->lattice->dim.y ? engine->lattice->dim.x : engine->lattice->dim.y;
+    return 1-1/(n*n);
+}
+
+/**
+ * This function is called by the first thread after each sweep and
+ * computes the parameters of the next one.
+ */
+void engine_chebyshev_update(struct engine* engine, double diff) {
+    struct chebyshev* c = &engine->chebyshev;
+    c->step++;
+
+    if(c->estimating) {
+        if(c->step == ENGINE_CHEBYSHEV_SETTLE)
+            c->start = diff;
+        if(c->step < ENGINE_CHEBYSHEV_ESTIMATE)
+            return;
+
+        /* power iteration: the differences decay with the spectral radius */
+        double rho = 0;
+        if(c->start > 0 && diff > 0)
+            rho = pow(diff/c->start, 1.0/(ENGINE_CHEBYSHEV_ESTIMATE-ENGINE_CHEBYSHEV_SETTLE));
+
+        if(rho > engine_chebyshev_bound(engine))
+            rho = engine_chebyshev_bound(engine);
+
+        /* the estimate is always from below, never decrease it */
+        if(rho > c->rho)
+            c->rho = rho;
+        c->estimating = false;
+        c->step = 0;
+        /* the accelerated differences are not comparable with the ones before */
+        monitor_init(&engine->monitor);
+    }
+
+    /* eigenvalues are in [0, rho], map them onto [-sigma, sigma] */
+    double sigma = c->rho/(2-c->rho);
+    c->gamma = 2/(2-c->rho);
+    if(c->step == 0)
+        c->omega = 1;
+    else if(c->step == 1)
+        c->omega = 1/(1-sigma*sigma/2);
+    else
+        c->omega = 1/(1-sigma*sigma*c->omega/4);
+
+    /*
+     * compare the achieved convergence with the expected one, a fixed
+     * margin never triggers for spectral radii close to 1, so the rate
+     * has to reach at least the square root of the expected one
+     */
+    if(c->step == ENGINE_CHEBYSHEV_CHECK/2)
+        c->start = diff;
+    if(c->step == ENGINE_CHEBYSHEV_CHECK) {
+        double expected = sqrt(c->omega-1);
+        double achieved = pow(diff/c->start, 2.0/ENGINE_CHEBYSHEV_CHECK);
+        if(achieved > sqrt(expected) && c->rho < engine_chebyshev_bound(engine)) {
+            /* rho was underestimated, the slowest modes dominate now */
+            engine_chebyshev_restart(engine);
+        } else {
+            /* keep going, check again after the next window */
+            c->step = ENGINE_CHEBYSHEV_CHECK/2;
+            c->start = diff;
+        }
+    }
+}
+
+/**
+ * This function solves one row exactly while the adjacent rows are
+ * kept constant. Consecutive free cells form a tridiagonal system
+ * which is solved with the Thomas algorithm. Cells connected to a
+ * surface between cells end the system, the surface is treated like
+ * any other constant value.
+ */
+double engine_relax_row(struct engine_thread* thread, uint32_t j) {
+    struct lattice* lattice = thread->engine->lattice;
+    uint32_t w = lattice->dim.x;
+    double* c = thread->c;
+    double* d = thread->d;
+    double diff = 0;
+
+    uint32_t i = 0;
+    while(i < w) {
+        /* find the next system of consecutive free cells */
+        if(lattice->update[i+j*w] == NULL) {
+            i++;
+            continue;
+        }
+        uint32_t start = i;
+
+        /* forward elimination */
+        do {
+            uint32_t index = i+j*w;
+            struct cell* cell = &lattice->cells[index];
+
+            double diag = cell->coef[0]+cell->coef[1]+cell->coef[2]+cell->coef[3];
+            double rhs = cell->coef[0]*lattice->cells[cell->adj[0]].value
+                       + cell->coef[1]*lattice->cells[cell->adj[1]].value;
+
+            /* the left cell is either part of the system or constant */
+            bool linked_left = i > start;
+            if(!linked_left)
+                rhs += cell->coef[2]*lattice->cells[cell->adj[2]].value;
+
+            /* the right cell is only part of the system if both cells see each other */
+            bool linked_right = i+1 < w
+                             && lattice->update[index+1] != NULL
+                             && cell->adj[3] == index+1
+                             && lattice->cells[index+1].adj[2] == index;
+            double upper = 0;
+            if(linked_right)
+                upper = -cell->coef[3];
+            else
+                rhs += cell->coef[3]*lattice->cells[cell->adj[3]].value;
+
+            double lower = linked_left ? -cell->coef[2] : 0;
+            double m = diag;
+            if(linked_left) {
+                m -= lower*c[i-1];
+                rhs -= lower*d[i-1];
+            }
+            c[i] = upper/m;
+            d[i] = rhs/m;
+
+            i++;
+            if(!linked_right)
+                break;
+        } while(1);
+
+        /* back substitution */
+        double next = 0;
+        for(uint32_t k = i; k-- > start;) {
+            struct cell* cell = &lattice->cells[k+j*w];
+            double value = d[k];
+            if(k+1 < i)
+                value -= c[k]*next;
+
+            double check = fabs(value-cell->value);
+            if(check > diff) diff = check;
+
+            cell->value = value;
+            next = value;
+        }
+    }
+
+    return diff;
+}
+
+/**
+ * This function is the same as engine_relax_row for several fields at
+ * once. The elimination factors only depend on the coefficients, so
+ * they are computed once per cell and applied to the right hand sides
+ * of all fields. The fields of a cell are adjacent in memory, the
+ * inner loops run over them with unit stride.
+ */
+double engine_relax_row_fields(struct engine_thread* thread, uint32_t j) {
+    struct engine* engine = thread->engine;
+    struct lattice* lattice = engine->lattice;
+    uint32_t w = lattice->dim.x;
+    uint32_t n = engine->fields;
+    double* values = engine->values;
+    double* c = thread->c;
+    double* d = thread->d;
+    double diff = 0;
+
+    uint32_t i = 0;
+    while(i < w) {
+        /* find the next system of consecutive free cells */
+        if(lattice->update[i+j*w] == NULL) {
+            i++;
+            continue;
+        }
+        uint32_t start = i;
+
+        /* forward elimination */
+        do {
+            uint32_t index = i+j*w;
+            struct cell* cell = &lattice->cells[index];
+            double* rhs = &d[(size_t) i*n];
+            const double* v0 = &values[(size_t) cell->adj[0]*n];
+            const double* v1 = &values[(size_t) cell->adj[1]*n];
+            double w0 = cell->coef[0];
+            double w1 = cell->coef[1];
+
+            double diag = cell->coef[0]+cell->coef[1]+cell->coef[2]+cell->coef[3];
+            for(uint32_t f = 0; f < n; f++)
+                rhs[f] = w0*v0[f]+w1*v1[f];
+
+            /* the left cell is either part of the system or constant */
+            bool linked_left = i > start;
+            if(!linked_left) {
+                const double* v2 = &values[(size_t) cell->adj[2]*n];
+                double w2 = cell->coef[2];
+                for(uint32_t f = 0; f < n; f++)
+                    rhs[f] += w2*v2[f];
+            }
+
+            /* the right cell is only part of the system if both cells see each other */
+            bool linked_right = i+1 < w
+                             && lattice->update[index+1] != NULL
+                             && cell->adj[3] == index+1
+                             && lattice->cells[index+1].adj[2] == index;
+            double upper = 0;
+            if(linked_right) {
+                upper = -cell->coef[3];
+            } else {
+                const double* v3 = &values[(size_t) cell->adj[3]*n];
+                double w3 = cell->coef[3];
+                for(uint32_t f = 0; f < n; f++)
+                    rhs[f] += w3*v3[f];
+            }
+
+            double lower = linked_left ? -cell->coef[2] : 0;
+            double m = diag;
+            if(linked_left) {
+                m -= lower*c[i-1];
+                const double* previous = &d[(size_t) (i-1)*n];
+                for(uint32_t f = 0; f < n; f++)
+                    rhs[f] -= lower*previous[f];
+            }
+            c[i] = upper/m;
+            for(uint32_t f = 0; f < n; f++)
+                rhs[f] /= m;
+
+            i++;
+            if(!linked_right)
+                break;
+        } while(1);
+
+        /* back substitution, the next cell of the system is already updated */
+        for(uint32_t k = i; k-- > start;) {
+            double* value = &values[(size_t) (k+j*w)*n];
+            const double* next = value+n;
+            const double* dk = &d[(size_t) k*n];
+            bool last = k+1 == i;
+            for(uint32_t f = 0; f < n; f++) {
+                double v = dk[f];
+                if(!last)
+                    v -= c[k]*next[f];
+
+                double check = fabs(v-value[f]);
+                if(check > diff) diff = check;
+
+                value[f] = v;
+            }
+        }
+    }
+
+    return diff;
+}
+
+/**
+ * This function is called by the first thread. It evaluates the
+ * quantity of interest and checks whether it stayed within the
+ * relative tolerance over the last span evaluations.
+ */
+bool engine_quantity_converged(struct engine* engine) {
+    uint8_t span = engine->conf.span;
+    double* q = engine->quantities;
+
+    /* shift the history */
+    for(uint8_t k = 0; k < span; k++)
+        q[k] = q[k+1];
+    q[span] = engine->quantity(engine->cb_ptr);
+    engine->evaluations++;
+
+    if(engine->evaluations <= span || q[span] == 0)
+        return false;
+
+    for(uint8_t k = 0; k < span; k++)
+        if(fabs(q[k]-q[span]) > engine->conf.tolerance*fabs(q[span]))
+            return false;
+
+    return true;
+}
+
+bool engine_anderson_new(struct engine* engine) {
+    struct anderson* a = &engine->anderson;
+    uint32_t m = engine->lattice->dim.x*engine->lattice->dim.y;
+    uint8_t window = engine->conf.window;
+
+    if(window < 1)
+        window = 1;
+    engine->conf.window = window;
+
+    a->count = 0;
+    a->column = 0;
+    a->norm = 0;
+    a->first = true;
+
+    engine->current = malloc(m*sizeof(double));
+    a->x = malloc(m*sizeof(double));
+    a->f = malloc(m*sizeof(double));
+    a->dx = calloc(window, sizeof(double*));
+    a->df = calloc(window, sizeof(double*));
+    a->gram = calloc(window*window, sizeof(double));
+    a->gamma = calloc(window, sizeof(double));
+    a->partial = calloc(engine->conf.threads*(2*window+1), sizeof(double));
+    if(engine->current == NULL || a->x == NULL || a->f == NULL || a->dx == NULL
+    || a->df == NULL || a->gram == NULL || a->gamma == NULL || a->partial == NULL)
+        return false;
+
+    for(uint8_t k = 0; k < window; k++) {
+        a->dx[k] = malloc(m*sizeof(double));
+        a->df[k] = malloc(m*sizeof(double));
+        if(a->dx[k] == NULL || a->df[k] == NULL)
+            return false;
+    }
+
+    /* the first iterate is the initial lattice */
+    for(uint32_t index = 0; index < m; index++)
+        engine->current[index] = engine->lattice->cells[index].value;
+
+    return true;
+}
+
+void engine_anderson_delete(struct engine* engine) {
+    struct anderson* a = &engine->anderson;
+
+    for(uint8_t k = 0; k < engine->conf.window; k++) {
+        if(a->dx != NULL) free(a->dx[k]);
+        if(a->df != NULL) free(a->df[k]);
+    }
+    free(a->x);
+    free(a->f);
+    free(a->dx);
+    free(a->df);
+    free(a->gram);
+    free(a->gamma);
+    free(a->partial);
+}
+
+/**
+ * This function applies one anderson mixing step. The lattice contains
+ * the result of the last sweeps g(x) started from the current iterate
+ * x, so the residual is f = g(x) - x. The new iterate is
+ *
+ *     x' = x + f - sum_k gamma_k*(dx_k + df_k)
+ *
+ * with gamma minimising |f - sum_k gamma_k*df_k|.
+ */
+void engine_anderson(struct engine_thread* thread) {
+    struct engine* engine = thread->engine;
+    struct lattice* lattice = engine->lattice;
+    struct anderson* a = &engine->anderson;
+    uint32_t w = lattice->dim.x;
+    uint8_t window = engine->conf.window;
+    uint8_t column = a->column;
+    uint8_t count = a->count < window ? a->count+1 : window;
+    double* partial = &a->partial[thread->id*(2*window+1)];
+    uint32_t first, last;
+
+    engine_rows(thread, &first, &last);
+
+    /* store the new differences and compute this thread's share of the inner products */
+    for(uint8_t k = 0; k < 2*window+1; k++)
+        partial[k] = 0;
+    for(uint32_t index = first*w; index < last*w; index++) {
+        if(lattice->update[index] == NULL)
+            continue;
+
+        double x = engine->current[index];
+        double f = lattice->cells[index].value-x;
+        if(!a->first) {
+            a->dx[column][index] = x-a->x[index];
+            a->df[column][index] = f-a->f[index];
+            for(uint8_t k = 0; k < count; k++) {
+                partial[k] += a->df[column][index]*a->df[k][index];
+                partial[window+k] += a->df[k][index]*f;
+            }
+        }
+        partial[2*window] += f*f;
+        a->x[index] = x;
+        a->f[index] = f;
+    }
+    pthread_barrier_wait(&engine->barrier);
+
+    if(thread->id == 0)
+        engine_anderson_solve(engine);
+    pthread_barrier_wait(&engine->barrier);
+
+    /* mix the iterates */
+    for(uint32_t index = first*w; index < last*w; index++) {
+        if(lattice->update[index] == NULL)
+            continue;
+
+        double value = a->x[index]+a->f[index];
+        for(uint8_t k = 0; k < a->count; k++)
+            value -= a->gamma[k]*(a->dx[k][index]+a->df[k][index]);
+
+        lattice->cells[index].value = value;
+        engine->current[index] = value;
+    }
+    pthread_barrier_wait(&engine->barrier);
+}
+
+/**
+ * This function is called by the first thread. It collects the inner
+ * products and solves the small least squares problem through its
+ * normal equations.
+ */
+void engine_anderson_solve(struct engine* engine) {
+    struct anderson* a = &engine->anderson;
+    uint8_t window = engine->conf.window;
+    uint8_t column = a->column;
+
+    /* sum up the inner products of all threads */
+    double sums[2*window+1];
+    for(uint8_t k = 0; k < 2*window+1; k++) {
+        sums[k] = 0;
+        for(uint8_t t = 0; t < engine->conf.threads; t++)
+            sums[k] += a->partial[t*(2*window+1)+k];
+    }
+
+    double norm = sums[2*window];
+    if(a->first) {
+        a->first = false;
+        a->norm = norm;
+        return;
+    }
+
+    /* the mixing made things worse, start over with the plain sweeps */
+    if(norm > a->norm) {
+        a->count = 0;
+        a->column = 0;
+        a->norm = norm;
+        return;
+    }
+    a->norm = norm;
+
+    /* the new column replaces the oldest one */
+    if(a->count < window)
+        a->count++;
+    a->column = (column+1)%window;
+    for(uint8_t k = 0; k < a->count; k++) {
+        a->gram[column*window+k] = sums[k];
+        a->gram[k*window+column] = sums[k];
+    }
+
+    /* normal equations with a little regularisation */
+    uint8_t n = a->count;
+    double matrix[n][n+1];
+    double regularisation = 0;
+    for(uint8_t i = 0; i < n; i++)
+        if(a->gram[i*window+i] > regularisation) regularisation = a->gram[i*window+i];
+    regularisation *= 1e-12;
+    for(uint8_t i = 0; i < n; i++) {
+        for(uint8_t j = 0; j < n; j++)
+            matrix[i][j] = a->gram[i*window+j];
+        matrix[i][i] += regularisation;
+        matrix[i][n] = sums[window+i];
+    }
+
+    /* gaussian elimination with partial pivoting */
+    for(uint8_t i = 0; i < n; i++) {
+        uint8_t pivot = i;
+        for(uint8_t r = i+1; r < n; r++)
+            if(fabs(matrix[r][i]) > fabs(matrix[pivot][i])) pivot = r;
+        if(matrix[pivot][i] == 0) {
+            /* singular, fall back to the plain sweeps */
+            for(uint8_t k = 0; k < n; k++)
+                a->gamma[k] = 0;
+            return;
+        }
+        for(uint8_t c = 0; c <= n; c++) {
+            double tmp = matrix[i][c];
+            matrix[i][c] = matrix[pivot][c];
+            matrix[pivot][c] = tmp;
+        }
+        for(uint8_t r = i+1; r < n; r++) {
+            double factor = matrix[r][i]/matrix[i][i];
+            for(uint8_t c = i; c <= n; c++)
+                matrix[r][c] -= factor*matrix[i][c];
+        }
+    }
+    for(uint8_t i = n; i-- > 0;) {
+        double value = matrix[i][n];
+        for(uint8_t c = i+1; c < n; c++)
+            value -= matrix[i][c]*a->gamma[c];
+        a->gamma[i] = value/matrix[i][i];
+    }
+}
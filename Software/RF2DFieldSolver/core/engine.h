@@ -0,0 +1,230 @@
+#ifndef INCLUDE_ENGINE_H
+#define INCLUDE_ENGINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "lattice.h"
+#include "tuple.h"
+#include "worker.h"
+
+/**
+ * This structure contains the state of the chebyshev acceleration.
+ * The iteration matrix of the symmetric sweep only has eigenvalues in
+ * [0, rho), rho is estimated from the decay of the differences of a
+ * few plain sweeps (power iteration), so no inner products are needed.
+ */
+struct chebyshev {
+    /**
+     * This is the estimated spectral radius of the symmetric sweep.
+     */
+    double rho;
+    /**
+     * These are the parameters used for the next sweep.
+     */
+    double omega;
+    double gamma;
+    /**
+     * This is true while plain sweeps are used to estimate rho.
+     */
+    bool estimating;
+    /**
+     * This is the number of sweeps since the last phase change.
+     */
+    uint32_t step;
+    /**
+     * This is the difference at the start of the measurement window.
+     */
+    double start;
+};
+
+/**
+ * This structure contains the state of the anderson mixing. The
+ * differences of the last iterates and of their residuals (result of
+ * a few sweeps minus the iterate) are kept in a ring buffer of window
+ * columns. The next iterate is the combination that minimises the
+ * residual in the least squares sense.
+ */
+struct anderson {
+    /**
+     * This is the iterate and the residual of the last mixing.
+     */
+    double* x;
+    double* f;
+    /**
+     * These are the columns of iterate and residual differences.
+     */
+    double** dx;
+    double** df;
+    /**
+     * This is the gram matrix of the residual differences (window x
+     * window), updated one column at a time.
+     */
+    double* gram;
+    /**
+     * These are the mixing coefficients.
+     */
+    double* gamma;
+    /**
+     * This contains the partial inner products of each thread.
+     */
+    double* partial;
+    /**
+     * This is the squared norm of the last residual.
+     */
+    double norm;
+    /**
+     * This is the number of valid columns.
+     */
+    uint8_t count;
+    /**
+     * This is the column replaced next.
+     */
+    uint8_t column;
+    /**
+     * This is true until the first residual is known.
+     */
+    bool first;
+};
+
+/**
+ * This structure represents a team of threads that relax the lattice
+ * in lockstep. Every sweep is split into phases which are separated by
+ * a barrier, so the threads never need to know about each other's
+ * position like the pipelined workers do.
+ */
+struct engine {
+    /**
+     * This is the lattice being computed.
+     */
+    struct lattice* lattice;
+    /**
+     * These are the values of several fields of the lattice, interleaved
+     * per cell, or @{code NULL} if the values of the cells are computed.
+     */
+    double* values;
+    uint32_t fields;
+    /**
+     * This is the configuration of the computation.
+     */
+    struct config conf;
+    /**
+     * This is the barrier separating the phases of a sweep.
+     */
+    pthread_barrier_t barrier;
+    /**
+     * This is held while the team is started.
+     */
+    pthread_mutex_t start;
+    /**
+     * This contains the largest difference of the last sweep for
+     * each thread.
+     */
+    double* diffs;
+    /**
+     * This is the number of sweeps done so far.
+     */
+    uint32_t iterations;
+    /**
+     * This is set by the first thread once the computation is finished.
+     */
+    bool done;
+    /**
+     * These are the previous and the current iterate of all cells,
+     * only allocated for the chebyshev acceleration (the anderson
+     * mixing only uses the current one).
+     */
+    double* last;
+    double* current;
+    struct chebyshev chebyshev;
+    struct anderson anderson;
+    /**
+     * These are the last values of the quantity of interest.
+     */
+    double* quantities;
+    uint32_t evaluations;
+    /**
+     * This watches the differences for stagnation and divergence.
+     */
+    struct monitor monitor;
+
+    progress_callback_t cb;
+    quantity_callback_t quantity;
+    void *cb_ptr;
+};
+
+/**
+ * This structure contains the private data of one thread of the team.
+ */
+struct engine_thread {
+    struct engine* engine;
+    uint8_t id;
+    pthread_t thread;
+    /**
+     * These are scratch buffers of one row for the line solver (the
+     * right hand sides for every field).
+     */
+    double* c;
+    double* d;
+};
+
+/**
+ * This function computes the laplace equation for a given lattice with
+ * the method selected in the configuration. All threads work on the
+ * same sweep and synchronise at the end of each phase.
+ *
+ * The line relaxation (zebra) solves all free cells of a row at once
+ * with the Thomas algorithm. Even rows only depend on odd rows and
+ * vice versa, so the rows of one colour are distributed across the
+ * threads.
+ *
+ * The chebyshev acceleration replaces each sweep by a symmetric one
+ * (even, odd, even rows) and extrapolates the result based on the
+ * previous iterates.
+ *
+ * The anderson mixing keeps the plain sweeps and replaces the iterate
+ * every few sweeps by the combination of the last iterates that
+ * minimises the residual.
+ *
+ * If an interval is configured, the quantity of interest is evaluated
+ * by the first thread every interval sweeps while the other threads
+ * wait. The computation stops once it changed by less than the
+ * relative tolerance over the last span evaluations, or as usual if
+ * the difference drops below the threshold.
+ *
+ * If the differences stagnate or diverge, the computation is stopped
+ * and the result of the lattice is set accordingly.
+ *
+ * @param lattice
+ *        This is a pointer to the lattice.
+ * @param conf
+ *        This is a pointer the configuration of the computation.
+ *
+ * @return The number of iterations.
+ */
+uint32_t engine_compute(struct lattice* lattice, struct config* conf, progress_callback_t cb, quantity_callback_t quantity, void *cb_ptr);
+
+/**
+ * This function computes several fields of the same lattice at once,
+ * e.g. one excitation per conductor. It works like engine_compute, but
+ * every sweep relaxes all fields, so the coefficients and the adjacent
+ * indexes of a cell are only loaded once. The difference is the largest
+ * one of all fields. The anderson mixing is not available, the chebyshev
+ * acceleration is used instead (all fields share the same operator and
+ * thus the same spectral radius).
+ *
+ * @param lattice
+ *        This is a pointer to the lattice, its values are not used.
+ * @param values
+ *        These are the values of the fields, fields values per cell.
+ * @param fields
+ *        This is the number of fields.
+ * @param conf
+ *        This is a pointer the configuration of the computation.
+ *
+ * @return The number of iterations.
+ */
+uint32_t engine_compute_fields(struct lattice* lattice, double* values, uint32_t fields, struct config* conf, progress_callback_t cb, quantity_callback_t quantity, void *cb_ptr);
+
+#endif
@@ -0,0 +1,126 @@
+#include <stdlib.h>
+
+#include "fields.h"
+#include "engine.h"
+
+struct fields* fields_new(struct lattice* lattice, const double* potentials, uint32_t conductors, uint32_t count) {
+    uint32_t m = lattice->dim.x*lattice->dim.y+lattice->ghosts;
+    struct fields* fields = malloc(sizeof(struct fields));
+    if(fields == NULL)
+        return NULL;
+
+    fields->lattice = lattice;
+    fields->count = count;
+    fields->values = malloc((size_t) m*count*sizeof(double));
+    if(fields->values == NULL) {
+        free(fields);
+        return NULL;
+    }
+
+    for(uint32_t index = 0; index < m; index++) {
+        struct cell* cell = &lattice->cells[index];
+        double* values = &fields->values[(size_t) index*count];
+        for(uint32_t f = 0; f < count; f++) {
+            if(cell->cond == DIRICHLET)
+                values[f] = cell->conductor < conductors ? potentials[f*conductors+cell->conductor] : 0;
+            else if(lattice->update[index] != NULL)
+                values[f] = 0;
+            else
+                values[f] = cell->value;
+        }
+    }
+
+    return fields;
+}
+
+void fields_delete(struct fields* fields) {
+    free(fields->values);
+    free(fields);
+}
+
+void fields_reset(struct fields* fields) {
+    struct lattice* lattice = fields->lattice;
+    uint32_t m = lattice->dim.x*lattice->dim.y;
+
+    for(uint32_t index = 0; index < m; index++)
+        if(lattice->update[index] != NULL)
+            for(uint32_t f = 0; f < fields->count; f++)
+                fields->values[(size_t) index*fields->count+f] = 0;
+
+    lattice_reset(lattice);
+}
+
+void fields_interpolate(struct fields* fields, struct fields* from) {
+    struct lattice* lattice = fields->lattice;
+    uint32_t w = lattice->dim.x;
+    uint32_t h = lattice->dim.y;
+    uint32_t fw = from->lattice->dim.x;
+    uint32_t fh = from->lattice->dim.y;
+    uint32_t n = fields->count;
+
+    if(from->count != n)
+        return;
+
+    for(uint32_t index = 0; index < w*h; index++) {
+        /* only free cells take the initial value */
+        if(lattice->update[index] == NULL)
+            continue;
+
+        struct cell* cell = &lattice->cells[index];
+
+        /* position in the other matrix, shifted by its outside row and column */
+        double x = cell->pos.x/from->lattice->step.x+1;
+        double y = cell->pos.y/from->lattice->step.y+1;
+        if(x < 0) x = 0;
+        if(y < 0) y = 0;
+        if(x > fw-1) x = fw-1;
+        if(y > fh-1) y = fh-1;
+
+        uint32_t i = x;
+        uint32_t j = y;
+        if(i > fw-2) i = fw-2;
+        if(j > fh-2) j = fh-2;
+        double fx = x-i;
+        double fy = y-j;
+
+        /* bilinear interpolation of the four surrounding cells, for all fields */
+        const double* v00 = &from->values[(size_t) (i+j*fw)*n];
+        const double* v10 = &from->values[(size_t) (i+1+j*fw)*n];
+        const double* v01 = &from->values[(size_t) (i+(j+1)*fw)*n];
+        const double* v11 = &from->values[(size_t) (i+1+(j+1)*fw)*n];
+        double* values = &fields->values[(size_t) index*n];
+        for(uint32_t f = 0; f < n; f++)
+            values[f] = (1-fy)*((1-fx)*v00[f]+fx*v10[f])+fy*((1-fx)*v01[f]+fx*v11[f]);
+    }
+}
+
+void fields_load(struct fields* fields, uint32_t field) {
+    struct lattice* lattice = fields->lattice;
+    uint32_t m = lattice->dim.x*lattice->dim.y+lattice->ghosts;
+
+    for(uint32_t index = 0; index < m; index++)
+        lattice->cells[index].value = fields->values[(size_t) index*fields->count+field];
+}
+
+void fields_combine(struct fields* fields, const double* weights) {
+    struct lattice* lattice = fields->lattice;
+    uint32_t m = lattice->dim.x*lattice->dim.y+lattice->ghosts;
+
+    for(uint32_t index = 0; index < m; index++) {
+        struct cell* cell = &lattice->cells[index];
+        if(cell->cond != DIRICHLET && lattice->update[index] == NULL)
+            continue;
+
+        const double* values = &fields->values[(size_t) index*fields->count];
+        double value = 0;
+        for(uint32_t f = 0; f < fields->count; f++)
+            value += weights[f]*values[f];
+        cell->value = value;
+    }
+}
+
+uint32_t fields_compute(struct fields* fields, struct config* conf, progress_callback_t cb, quantity_callback_t quantity, void *cb_ptr) {
+    struct config c = *conf;
+    c.method = METHOD_ZEBRA;
+    return engine_compute_fields(fields->lattice, fields->values, fields->count, &c, cb, quantity, cb_ptr);
+}
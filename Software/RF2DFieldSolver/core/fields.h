@@ -0,0 +1,128 @@
+#ifndef INCLUDE_FIELDS_H
+#define INCLUDE_FIELDS_H
+
+#include <stdint.h>
+
+#include "lattice.h"
+#include "worker.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * This structure contains several potential fields of the same lattice,
+ * e.g. one excitation per conductor. The values are interleaved per
+ * cell (count values per cell, including the additional dirichlet cells
+ * after the matrix), so a sweep loads the coefficients and the adjacent
+ * indexes of a cell once for all fields instead of once per lattice.
+ */
+struct fields {
+    /**
+     * This is the lattice defining the geometry, its values are not used.
+     */
+    struct lattice* lattice;
+    /**
+     * This is the number of fields.
+     */
+    uint32_t count;
+    /**
+     * These are the values of all fields.
+     */
+    double* values;
+};
+
+/**
+ * This function creates the fields of a lattice. Every field has its own
+ * potential for each conductor, all free cells start at zero.
+ *
+ * @param lattice
+ *        This is a pointer to the lattice.
+ * @param potentials
+ *        These are the potentials, conductors values per field.
+ * @param conductors
+ *        This is the number of potentials per field, conductors with a
+ *        higher number are set to zero.
+ * @param count
+ *        This is the number of fields.
+ *
+ * @return The pointer to the new fields if everyhthing went as
+ *         expected, else @{code NULL} value.
+ */
+struct fields* fields_new(struct lattice* lattice, const double* potentials, uint32_t conductors, uint32_t count);
+
+/**
+ * This function frees the memory of the fields, the lattice is kept.
+ *
+ * @param fields
+ *        This is a pointer to the fields to free.
+ */
+void fields_delete(struct fields* fields);
+
+/**
+ * This function resets all free cells of all fields to zero and clears
+ * the abort request and the result of the lattice, e.g. to restart a
+ * diverged computation.
+ *
+ * @param fields
+ *        This is a pointer to the fields.
+ */
+void fields_reset(struct fields* fields);
+
+/**
+ * This function initialises the free cells of all fields with the fields
+ * of an other lattice covering the same area, e.g. the solution of a
+ * slightly different geometry. The values are bilinearly interpolated
+ * like with lattice_interpolate, a good initial value saves many
+ * iterations.
+ *
+ * @param fields
+ *        This is a pointer to the fields to initialise.
+ * @param from
+ *        This is a pointer to the fields containing the potentials, with
+ *        the same number of fields.
+ */
+void fields_interpolate(struct fields* fields, struct fields* from);
+
+/**
+ * This function copies one field into the values of the lattice, so
+ * everything that works on a lattice (charge, energy, electric field)
+ * can be used for it.
+ *
+ * @param fields
+ *        This is a pointer to the fields.
+ * @param field
+ *        This is the index of the field.
+ */
+void fields_load(struct fields* fields, uint32_t field);
+
+/**
+ * This function stores the weighted sum of all fields in the values of
+ * the lattice (superposition of the excitations). Only the free and the
+ * dirichlet cells are changed.
+ *
+ * @param fields
+ *        This is a pointer to the fields.
+ * @param weights
+ *        These are the weights, one per field.
+ */
+void fields_combine(struct fields* fields, const double* weights);
+
+/**
+ * This function computes all fields with the zebra line relaxation,
+ * the configured method is ignored.
+ *
+ * @param fields
+ *        This is a pointer to the fields.
+ * @param conf
+ *        This is a pointer the configuration of the computation.
+ *
+ * @return The number of iterations.
+ */
+uint32_t fields_compute(struct fields* fields, struct config* conf, progress_callback_t cb, quantity_callback_t quantity, void *cb_ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
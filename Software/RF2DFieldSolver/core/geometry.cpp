@@ -0,0 +1,197 @@
+#include "geometry.h"
+
+#include "polygon.h"
+
+#include <algorithm>
+#include <cmath>
+
+int Shape::getConductor() const
+{
+    switch(type) {
+    case Type::TracePos:
+    case Type::TraceNeg:
+        return conductor;
+    case Type::Dielectric:
+    case Type::GND:
+    case Type::Last:
+        break;
+    }
+    return 0;
+}
+
+bool Shape::isLine() const
+{
+    // only conductors can be modelled without thickness
+    return line && type != Type::Dielectric;
+}
+
+Geometry::Geometry()
+{
+
+}
+
+double Geometry::getDielectricConstantAt(const Point &p) const
+{
+    for(auto &s : shapes) {
+        if(s.isLine()) {
+            // no area, does not change the dielectric constant
+            continue;
+        }
+        if(Polygon::contains(s.vertices, p)) {
+            // this polygon defines the weight at these coordinates
+            switch(s.type) {
+            case Shape::Type::GND:
+            case Shape::Type::TracePos:
+            case Shape::Type::TraceNeg:
+                return 1.0;
+            case Shape::Type::Dielectric:
+                return s.epsilonR;
+            case Shape::Type::Last:
+                return 1.0;
+            }
+        }
+    }
+    // not found, we are in the air
+    return 1.0;
+}
+
+double Geometry::getDielectricConstantIn(const Rect &rect) const
+{
+    double totalArea = std::abs(rect.width() * rect.height());
+    if(totalArea <= 0) {
+        return getDielectricConstantAt(rect.center());
+    }
+    // shapes earlier in the list take priority for overlapping areas (same as in getDielectricConstantAt)
+    double remaining = 1.0;
+    double sum = 0;
+    // there is no field inside the conductors, they do not count towards the average
+    double conductors = 0;
+    for(unsigned int i=0;i<shapes.size() && remaining > 0;i++) {
+        auto &s = shapes[i];
+        if(s.isLine()) {
+            continue;
+        }
+        double fraction = Polygon::intersectionArea(s.vertices, rect) / totalArea;
+        if(fraction <= 0) {
+            continue;
+        }
+        if(fraction > remaining) {
+            fraction = remaining;
+        }
+        if(s.type == Shape::Type::Dielectric) {
+            sum += fraction * s.epsilonR;
+        } else {
+            conductors += fraction;
+        }
+        remaining -= fraction;
+    }
+    // the rest is air
+    sum += remaining * 1.0;
+    if(conductors >= 1.0) {
+        return 1.0;
+    }
+    return sum / (1.0 - conductors);
+}
+
+bool Geometry::hasDielectric() const
+{
+    for(auto &s : shapes) {
+        if(s.type == Shape::Type::Dielectric && s.epsilonR != 1.0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Geometry::check(std::string &error, std::vector<std::string> &warnings) const
+{
+    auto isTrace = [](const Shape &s) -> bool {
+        return s.type == Shape::Type::TracePos || s.type == Shape::Type::TraceNeg;
+    };
+    // check for self-intersecting polygons
+    for(auto &s : shapes) {
+        if(s.isLine()) {
+            // open polyline, no closing edge that could intersect
+            continue;
+        }
+        if(Polygon::selfIntersects(s.vertices)) {
+            error = "Element \""+s.name+"\" self intersects, this is not supported";
+            return false;
+        }
+    }
+    // check for short circuits between RF and GND
+    for(auto &s1 : shapes) {
+        if(s1.type != Shape::Type::GND) {
+            continue;
+        }
+        for(auto &s2 : shapes) {
+            if(!isTrace(s2)) {
+                continue;
+            }
+            // check for overlap
+            if(Polygon::intersects(s1.vertices, s2.vertices)) {
+                error = "Short circuit between RF \""+s2.name+"\" and GND \""+s1.name+"\"";
+                return false;
+            }
+        }
+    }
+    // check for overlapping/touching RF elements
+    for(unsigned int i=0;i<shapes.size();i++) {
+        auto &s1 = shapes[i];
+        if(!isTrace(s1)) {
+            continue;
+        }
+        for(unsigned int j=i+1;j<shapes.size();j++) {
+            auto &s2 = shapes[j];
+            if(!isTrace(s2)) {
+                continue;
+            }
+            // check for overlap
+            if(Polygon::intersects(s1.vertices, s2.vertices)) {
+                error = "Traces \""+s2.name+"\" and \""+s1.name+"\" touch/overlap, this is not supported";
+                return false;
+            }
+        }
+    }
+    // a conductor has only one potential
+    for(auto &s1 : shapes) {
+        if(s1.type != Shape::Type::TracePos) {
+            continue;
+        }
+        for(auto &s2 : shapes) {
+            if(s2.type == Shape::Type::TraceNeg && s2.getConductor() == s1.getConductor()) {
+                error = "Traces \""+s1.name+"\" and \""+s2.name+"\" are both part of conductor "+std::to_string(s1.getConductor())+", but of different types";
+                return false;
+            }
+        }
+    }
+    // check and warn about overlapping dielectrics (touching is fine)
+    for(unsigned int i=0;i<shapes.size();i++) {
+        auto &s1 = shapes[i];
+        if(s1.type != Shape::Type::Dielectric) {
+            continue;
+        }
+        for(unsigned int j=i+1;j<shapes.size();j++) {
+            auto &s2 = shapes[j];
+            if(s2.type != Shape::Type::Dielectric) {
+                continue;
+            }
+            if(Polygon::overlapArea(s1.vertices, s2.vertices) > 0) {
+                warnings.push_back("Dielectric \""+s1.name+"\" and \""+s2.name+"\" overlap, \""+s1.name+"\" will be used for overlapping area");
+            }
+        }
+    }
+    return true;
+}
+
+std::vector<int> Geometry::getConductors() const
+{
+    std::vector<int> ret;
+    for(auto &s : shapes) {
+        if(s.getConductor() > 0 && std::find(ret.begin(), ret.end(), s.getConductor()) == ret.end()) {
+            ret.push_back(s.getConductor());
+        }
+    }
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
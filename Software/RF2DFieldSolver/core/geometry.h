@@ -0,0 +1,94 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <string>
+#include <vector>
+
+// Cross section of the transmission line as seen by the solver. Only uses the standard library,
+// the GUI converts its element list into this before a calculation
+
+class Point
+{
+public:
+    Point() : x(0), y(0) {}
+    Point(double x, double y) : x(x), y(y) {}
+
+    Point operator+(const Point &p) const {return Point(x + p.x, y + p.y);}
+    Point operator-(const Point &p) const {return Point(x - p.x, y - p.y);}
+    Point operator*(double f) const {return Point(x * f, y * f);}
+    Point &operator+=(const Point &p) {x += p.x; y += p.y; return *this;}
+    Point &operator*=(double f) {x *= f; y *= f; return *this;}
+    bool operator==(const Point &p) const {return x == p.x && y == p.y;}
+    bool operator!=(const Point &p) const {return !(*this == p);}
+    static double dotProduct(const Point &a, const Point &b) {return a.x * b.x + a.y * b.y;}
+
+    double x, y;
+};
+
+inline Point operator*(double f, const Point &p) {return p * f;}
+
+// axis aligned rectangle, min has the smaller coordinates in both directions
+class Rect
+{
+public:
+    Rect() {}
+    Rect(const Point &min, const Point &max) : min(min), max(max) {}
+
+    double width() const {return max.x - min.x;}
+    double height() const {return max.y - min.y;}
+    Point center() const {return (min + max) * 0.5;}
+
+    Point min, max;
+};
+
+// one element of the cross section
+class Shape
+{
+public:
+    enum class Type {
+        Dielectric,
+        TracePos,
+        TraceNeg,
+        GND,
+        Last,
+    };
+
+    Shape(Type type = Type::Dielectric) : type(type), epsilonR(1.0), conductor(0), line(false) {}
+
+    // traces with the same number are connected, GND and dielectrics have no conductor number
+    int getConductor() const;
+    // open polyline conductor without thickness instead of a closed polygon (only conductors)
+    bool isLine() const;
+
+    std::string name;
+    Type type;
+    double epsilonR;
+    int conductor;
+    bool line;
+    std::vector<Point> vertices;
+};
+
+class Geometry
+{
+public:
+    Geometry();
+
+    void addShape(const Shape &s) {shapes.push_back(s);}
+    const std::vector<Shape>& getShapes() const {return shapes;}
+
+    double getDielectricConstantAt(const Point &p) const;
+    // area weighted average of the dielectric constant within rect, only over the area outside of the conductors
+    double getDielectricConstantIn(const Rect &rect) const;
+    // true if at least one dielectric differs from air
+    bool hasDielectric() const;
+    // checks the shapes before a calculation, false with the reason if they are not supported. Issues that do
+    // not prevent the calculation are added to the warnings
+    bool check(std::string &error, std::vector<std::string> &warnings) const;
+    // sorted numbers of all conductors (connected traces share a number)
+    std::vector<int> getConductors() const;
+
+private:
+    std::vector<Shape> shapes;
+};
+
+#endif // GEOMETRY_H
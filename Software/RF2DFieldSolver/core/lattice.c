@@ -0,0 +1,898 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "lattice.h"
+#include "worker.h"
+#include "engine.h"
+
+/**
+ * This function setups each of the cell in the lattice.
+ */
+void lattice_set_size(struct lattice* lattice, struct rect* size);
+
+/**
+ * This function applies the boundary function to each of the cell.
+ */
+void lattice_apply_bound(struct lattice* lattice, bound_t func, void *ptr);
+
+/**
+ * This function applies the weight function to each of the cells.
+ */
+void lattice_apply_weight(struct lattice* lattice, weight_t func, void *ptr);
+
+/**
+ * This function generates the function for each of the cell.
+ */
+bool lattice_generate_function(struct lattice* lattice, edge_t func, void *ptr);
+
+/**
+ * This function applies one sequential iteration.
+ */
+double lattice_iterate(struct lattice* lattice);
+
+struct lattice* lattice_new(struct rect* size, struct point* dim, bound_t func, weight_t w_func, enum averaging averaging, edge_t e_func, void *ptr) {
+    struct cell* cells;
+    struct lattice* lattice;
+    double (**update)(struct lattice*, struct cell*);
+
+    /* make sure the dimension is useful */
+    if(dim->x == 0 || dim->y == 0)
+        return NULL;
+
+    /* add two rows and two columns */
+    dim->x += 3;
+    dim->y += 3;
+
+    /* compute the number of cell */
+    uint32_t m = dim->x*dim->y;
+
+    /* allocate memory for the cells */
+    cells = malloc(m*sizeof(struct cell));
+    if(cells == NULL) goto ERROR;
+
+    /* allocate memory for the functions */
+    update = malloc(m*sizeof(double (*)(struct lattice*, struct cell*)));
+    if(update == NULL) goto ERROR;
+
+    /* allocate the memory for the lattice structure */
+    lattice = malloc(sizeof(struct lattice));
+    if(lattice == NULL) goto ERROR;
+
+    /* initialise the lattice structure */
+    lattice->dim.x = dim->x;
+    lattice->dim.y = dim->y;
+    lattice->cells = cells;
+    lattice->update = update;
+    lattice->ghosts = 0;
+    lattice->boundary = NULL;
+    lattice->boundaries = 0;
+    lattice->field = NULL;
+    lattice->field_mean = 0;
+    lattice->averaging = averaging;
+    lattice->abort = false;
+    lattice->result = RESULT_NONE;
+    lattice->reached = 0;
+
+    /* apply all the steps for finishing the lattice */
+    lattice_set_size(lattice, size);
+    lattice_apply_bound(lattice, func, ptr);
+    lattice_apply_weight(lattice, w_func, ptr);
+    if(!lattice_generate_function(lattice, e_func, ptr)) {
+        lattice_delete(lattice);
+        return NULL;
+    }
+
+    return lattice;
+
+ERROR:
+    if(cells   != NULL) free(cells);
+    if(update  != NULL) free(update);
+    if(lattice != NULL) free(lattice);
+
+    return NULL;
+}
+
+void lattice_delete(struct lattice* lattice) {
+    /* free all the allocated memory */
+    free(lattice->cells);
+    free(lattice->update);
+    free(lattice->boundary);
+    free(lattice->field);
+    free(lattice);
+}
+
+void lattice_interpolate(struct lattice* lattice, struct lattice* from) {
+    uint32_t w = lattice->dim.x;
+    uint32_t h = lattice->dim.y;
+    uint32_t fw = from->dim.x;
+    uint32_t fh = from->dim.y;
+
+    for(uint32_t index = 0; index < w*h; index++) {
+        /* only free cells take the initial value */
+        if(lattice->update[index] == NULL)
+            continue;
+
+        struct cell* cell = &lattice->cells[index];
+
+        /* position in the other matrix, shifted by its outside row and column */
+        double x = cell->pos.x/from->step.x+1;
+        double y = cell->pos.y/from->step.y+1;
+        if(x < 0) x = 0;
+        if(y < 0) y = 0;
+        if(x > fw-1) x = fw-1;
+        if(y > fh-1) y = fh-1;
+
+        uint32_t i = x;
+        uint32_t j = y;
+        if(i > fw-2) i = fw-2;
+        if(j > fh-2) j = fh-2;
+        double fx = x-i;
+        double fy = y-j;
+
+        /* bilinear interpolation of the four surrounding cells */
+        double v00 = from->cells[i+j*fw].value;
+        double v10 = from->cells[i+1+j*fw].value;
+        double v01 = from->cells[i+(j+1)*fw].value;
+        double v11 = from->cells[i+1+(j+1)*fw].value;
+        cell->value = (1-fy)*((1-fx)*v00+fx*v10)+fy*((1-fx)*v01+fx*v11);
+    }
+}
+
+void lattice_reset(struct lattice* lattice) {
+    for(uint32_t index = 0; index < lattice->dim.x*lattice->dim.y; index++)
+        if(lattice->update[index] != NULL)
+            lattice->cells[index].value = 0;
+
+    lattice->abort = false;
+    lattice->result = RESULT_NONE;
+    lattice->reached = 0;
+}
+
+struct lattice* lattice_copy(struct lattice* lattice) {
+    uint32_t m = lattice->dim.x*lattice->dim.y+lattice->ghosts;
+    struct lattice* copy = malloc(sizeof(struct lattice));
+    if(copy == NULL)
+        return NULL;
+
+    *copy = *lattice;
+    copy->cells = malloc(m*sizeof(struct cell));
+    copy->update = malloc(m*sizeof(double (*)(struct lattice*, struct cell*)));
+    copy->boundary = malloc((lattice->boundaries ? lattice->boundaries : 1)*sizeof(uint32_t));
+    copy->field = NULL;
+    copy->field_mean = 0;
+    if(copy->cells == NULL || copy->update == NULL || copy->boundary == NULL) {
+        lattice_delete(copy);
+        return NULL;
+    }
+
+    memcpy(copy->cells, lattice->cells, m*sizeof(struct cell));
+    memcpy(copy->update, lattice->update, m*sizeof(double (*)(struct lattice*, struct cell*)));
+    memcpy(copy->boundary, lattice->boundary, lattice->boundaries*sizeof(uint32_t));
+    copy->abort = false;
+    copy->result = RESULT_NONE;
+    copy->reached = 0;
+
+    return copy;
+}
+
+void lattice_excite(struct lattice* lattice, const double* potentials, uint32_t count) {
+    uint32_t m = lattice->dim.x*lattice->dim.y+lattice->ghosts;
+
+    for(uint32_t index = 0; index < m; index++) {
+        struct cell* cell = &lattice->cells[index];
+        if(cell->cond == DIRICHLET)
+            cell->value = cell->conductor < count ? potentials[cell->conductor] : 0;
+        else if(lattice->update[index] != NULL)
+            cell->value = 0;
+    }
+}
+
+void lattice_print(struct lattice* lattice) {
+    /* extract the dimension of the lattice */
+    uint32_t w = lattice->dim.x;
+    uint32_t h = lattice->dim.y;
+
+    for(uint32_t j = 0; j < h; j++) {
+        for(uint32_t i = 0; i < w; i++) {
+            /* extract the pointer to the specified cell */
+            struct cell* cell = &lattice->cells[i+j*w];
+
+            /* don't print cells if they contain neumann condition */
+            if(cell->cond == NEUMANN)
+                fprintf(stderr, "          ,");
+            else
+                fprintf(stderr, "% 10.5f,", cell->value);
+        }
+        fprintf(stderr, "\n");
+    }
+}
+
+void lattice_set_size(struct lattice* lattice, struct rect* size) {
+    /* extract the dimension of the lattice */
+    int32_t w = lattice->dim.x;
+    int32_t h = lattice->dim.y;
+
+    /* compute the subdivisions */
+    double dx = size->x/(w-3);
+    double dy = size->y/(h-3);
+    lattice->step.x = dx;
+    lattice->step.y = dy;
+
+    for(int32_t j = -1; j+1 < h; j++) {
+        for(int32_t i = -1; i+1 < w; i++) {
+            /* extract the pointer to the specified cell */
+            struct cell* cell = &lattice->cells[(i+1)+(j+1)*w];
+
+            /* initialise the cell */
+            cell->pos.x = i*dx;
+            cell->pos.y = j*dy;
+            cell->index.x = i+1;
+            cell->index.y = j+1;
+            cell->value = 0;
+            cell->conductor = 0;
+
+            /* the limits of the lattice are Neumann conditions */
+            if(i == -1 || j == -1 || i == w-2 || j == h-2) {
+                /* we don't need the adjacent cells */
+                cell->adj[0] = 0;
+                cell->adj[1] = 0;
+                cell->adj[2] = 0;
+                cell->adj[3] = 0;
+
+                /* we don't need the adjacent cells */
+                cell->diag[0] = 0;
+                cell->diag[1] = 0;
+                cell->diag[2] = 0;
+                cell->diag[3] = 0;
+
+                cell->cond = NEUMANN;
+            } else {
+                /* compute the index of the adjacent cells */
+                cell->adj[0] = (i+1)+(j-0)*w;
+                cell->adj[1] = (i+1)+(j+2)*w;
+                cell->adj[2] = (i-0)+(j+1)*w;
+                cell->adj[3] = (i+2)+(j+1)*w;
+
+                /* compute the index of the diagonal cells */
+                cell->diag[0] = (i+2)+(j-0)*w;
+                cell->diag[1] = (i+2)+(j+2)*w;
+                cell->diag[2] = (i-0)+(j+2)*w;
+                cell->diag[3] = (i-0)+(j-0)*w;
+
+                cell->cond = UNSET;
+            }
+        }
+    }
+}
+
+void lattice_apply_bound(struct lattice* lattice, bound_t func, void *ptr) {
+    /* extract the dimension of the lattice */
+    uint32_t w = lattice->dim.x;
+    uint32_t h = lattice->dim.y;
+
+    /* used for returning data from the boundary function */
+    struct bound bound = {0, NONE, 0};
+
+    /* apply the boundary function to each cell */
+    for(uint32_t j = 0; j < h; j++) {
+        for(uint32_t i = 0; i < w; i++) {
+            /* extract the pointer to the specified cell */
+            struct cell* cell = &lattice->cells[i+j*w];
+
+            /* make sure the cell isn't already set */
+            if(cell->cond != UNSET)
+                continue;
+
+            /* apply the boundary function */
+            bound.conductor = 0;
+            if(func(ptr, &bound, &cell->pos) == NULL)
+                continue;
+
+            /* update the cell */
+            cell->value = bound.value;
+            cell->cond  = bound.cond;
+            cell->conductor = bound.conductor;
+        }
+    }
+}
+
+void lattice_apply_weight(struct lattice* lattice, weight_t func, void *ptr) {
+    /* extract the dimension of the lattice */
+    uint32_t w = lattice->dim.x;
+    uint32_t h = lattice->dim.y;
+
+    /* apply the weight function to each cell */
+    for(uint32_t j = 0; j < h; j++) {
+        for(uint32_t i = 0; i < w; i++) {
+            /* extract the pointer to the specified cell */
+            struct cell* cell = &lattice->cells[i+j*w];
+
+            /* update the cell */
+            cell->weight = func(ptr, &cell->pos);
+        }
+    }
+}
+
+/* smallest allowed distance to a dirichlet surface, in cell spacings */
+#define LATTICE_MIN_EDGE_FRACTION 0.01
+
+/**
+ * This function combines the weights of two adjacent cells into the
+ * coefficient of the stencil edge between them.
+ */
+static double lattice_edge_weight(struct lattice* lattice, struct cell* cell, struct cell* adj) {
+    /* there is no field inside a conductor, the edge only crosses the medium of the free cell */
+    if(adj->cond == DIRICHLET && lattice->averaging != AVERAGING_NONE)
+        return cell->weight;
+
+    switch(lattice->averaging) {
+    case AVERAGING_ARITHMETIC:
+        return (cell->weight+adj->weight)/2;
+    case AVERAGING_HARMONIC:
+        if(cell->weight+adj->weight <= 0)
+            return 0;
+        return 2*cell->weight*adj->weight/(cell->weight+adj->weight);
+    case AVERAGING_NONE:
+    default:
+        /* the weight of the cell cancels in its update, the product keeps the edge symmetric */
+        return cell->weight*adj->weight;
+    }
+}
+
+/**
+ * This function computes the coefficient of the stencil edge towards
+ * the adjacent cell k. The flux through an edge scales with the width
+ * of the cell face it crosses divided by the distance of the cells, so
+ * vertical edges (adjacent cells 1/2) are weighted with dx/dy and
+ * horizontal edges (adjacent cells 3/4) with dy/dx.
+ */
+static double lattice_edge_coef(struct lattice* lattice, struct cell* cell, int k) {
+    double weight = lattice_edge_weight(lattice, cell, &lattice->cells[cell->adj[k]]);
+    if(k < 2)
+        return weight*lattice->step.x/lattice->step.y;
+    else
+        return weight*lattice->step.y/lattice->step.x;
+}
+
+/**
+ * This structure stores a stencil edge that has to be connected to
+ * an additional dirichlet cell once all cells are generated.
+ */
+struct cut {
+    uint32_t index;
+    uint8_t k;
+    double value;
+    uint32_t conductor;
+};
+
+/**
+ * This structure is a growing list of cut stencil edges.
+ */
+struct cut_list {
+    struct cut* cuts;
+    uint32_t count;
+    uint32_t size;
+};
+
+static bool cut_list_append(struct cut_list* list, uint32_t index, uint8_t k, double value, uint32_t conductor) {
+    if(list->count == list->size) {
+        uint32_t size = list->size ? list->size*2 : 64;
+        struct cut* cuts = realloc(list->cuts, size*sizeof(struct cut));
+        if(cuts == NULL)
+            return false;
+        list->cuts = cuts;
+        list->size = size;
+    }
+    list->cuts[list->count].index = index;
+    list->cuts[list->count].k = k;
+    list->cuts[list->count].value = value;
+    list->cuts[list->count].conductor = conductor;
+    list->count++;
+    return true;
+}
+
+/**
+ * This function modifies the stencil of a free cell next to dirichlet
+ * surfaces with the Shortley-Weller scheme. For each axis, the distances
+ * to the adjacent cells (or the dirichlet surface in between) are h1
+ * and h2 in units of the cell spacing and the coefficients are scaled
+ * by 2/(h1*(h1+h2)) and 2/(h2*(h1+h2)) respectively.
+ */
+static bool lattice_apply_edge(struct lattice* lattice, uint32_t index, edge_t func, void *ptr, struct cut_list* cuts) {
+    struct cell* cell = &lattice->cells[index];
+    double h[4] = {1, 1, 1, 1};
+    bool modified = false;
+
+    for(int k = 0; k < 4; k++) {
+        struct cell* adj = &lattice->cells[cell->adj[k]];
+        if(adj->cond == NEUMANN)
+            continue;
+
+        /* prefill with the adjacent cell */
+        struct edge edge = {1.0, adj->value, adj->cond, adj->conductor};
+        if(func(ptr, &edge, &cell->pos, &adj->pos) == NULL || edge.cond != DIRICHLET)
+            continue;
+
+        /* very close surfaces are clamped to keep the stencil well conditioned */
+        double fraction = edge.fraction;
+        if(fraction < LATTICE_MIN_EDGE_FRACTION)
+            fraction = LATTICE_MIN_EDGE_FRACTION;
+        else if(fraction > 1)
+            fraction = 1;
+        h[k] = fraction;
+        if(fraction < 1)
+            modified = true;
+
+        /* the surface is not the adjacent cell, connect to an additional cell later on */
+        if(adj->cond != DIRICHLET || adj->value != edge.value || adj->conductor != edge.conductor) {
+            if(!cut_list_append(cuts, index, k, edge.value, edge.conductor))
+                return false;
+        }
+    }
+
+    if(!modified)
+        return true;
+
+    /* adjacent cells 1/2 and 3/4 are on the same axis */
+    for(int k = 0; k < 4; k++) {
+        double h1 = h[k];
+        double h2 = h[k^1];
+        cell->coef[k] *= 2/(h1*(h1+h2));
+    }
+    /* the flux is the coefficient times the area of the control volume, both axes are shortened */
+    double area = (h[0]+h[1])/2*(h[2]+h[3])/2;
+    cell->extent[0] *= area;
+    cell->extent[1] *= area;
+    return true;
+}
+
+/**
+ * This function creates the additional dirichlet cells for all cut
+ * stencil edges (one cell per distinct value) and connects the edges
+ * to them.
+ */
+static bool lattice_apply_cuts(struct lattice* lattice, struct cut_list* list) {
+    uint32_t m = lattice->dim.x*lattice->dim.y;
+
+    /* find the distinct surfaces (value and conductor) */
+    struct cut* surfaces = NULL;
+    uint32_t ghosts = 0;
+    for(uint32_t n = 0; n < list->count; n++) {
+        uint32_t g;
+        for(g = 0; g < ghosts; g++)
+            if(surfaces[g].value == list->cuts[n].value && surfaces[g].conductor == list->cuts[n].conductor)
+                break;
+        if(g == ghosts) {
+            struct cut* v = realloc(surfaces, (ghosts+1)*sizeof(struct cut));
+            if(v == NULL) goto ERROR;
+            surfaces = v;
+            surfaces[ghosts++] = list->cuts[n];
+        }
+    }
+
+    if(ghosts == 0)
+        return true;
+
+    /* extend the matrix */
+    struct cell* cells = realloc(lattice->cells, (m+ghosts)*sizeof(struct cell));
+    if(cells == NULL) goto ERROR;
+    lattice->cells = cells;
+
+    double (**update)(struct lattice*, struct cell*) = realloc(lattice->update, (m+ghosts)*sizeof(double (*)(struct lattice*, struct cell*)));
+    if(update == NULL) goto ERROR;
+    lattice->update = update;
+
+    /* initialise the additional cells, they are never updated */
+    for(uint32_t g = 0; g < ghosts; g++) {
+        struct cell* cell = &lattice->cells[m+g];
+        cell->pos.x = 0;
+        cell->pos.y = 0;
+        cell->index.x = 0;
+        cell->index.y = 0;
+        cell->value = surfaces[g].value;
+        cell->cond = DIRICHLET;
+        cell->conductor = surfaces[g].conductor;
+        cell->weight = 1.0;
+        cell->extent[0] = 0;
+        cell->extent[1] = 0;
+        for(int k = 0; k < 4; k++) {
+            cell->coef[k] = 0;
+            cell->adj[k] = 0;
+            cell->diag[k] = 0;
+        }
+        lattice->update[m+g] = NULL;
+    }
+    lattice->ghosts = ghosts;
+
+    /* connect the cut edges */
+    for(uint32_t n = 0; n < list->count; n++) {
+        for(uint32_t g = 0; g < ghosts; g++) {
+            if(surfaces[g].value == list->cuts[n].value && surfaces[g].conductor == list->cuts[n].conductor) {
+                lattice->cells[list->cuts[n].index].adj[list->cuts[n].k] = m+g;
+                break;
+            }
+        }
+    }
+
+    free(surfaces);
+    return true;
+
+ERROR:
+    if(surfaces != NULL) free(surfaces);
+    return false;
+}
+
+/**
+ * This function updates a cell based on the adjacent cells. The
+ * neumann borders are already mirrored into the coefficients, so
+ * the same formula applies to every configuration.
+ */
+static double func_stencil(struct lattice* lattice, struct cell* cell) {
+    double v1 = lattice->cells[cell->adj[0]].value;
+    double v2 = lattice->cells[cell->adj[1]].value;
+    double v3 = lattice->cells[cell->adj[2]].value;
+    double v4 = lattice->cells[cell->adj[3]].value;
+
+    double w1 = cell->coef[0];
+    double w2 = cell->coef[1];
+    double w3 = cell->coef[2];
+    double w4 = cell->coef[3];
+
+    return (v1*w1+v2*w2+v3*w3+v4*w4)/(w1+w2+w3+w4);
+}
+
+/**
+ * This function collects the free cells next to dirichlet cells (on
+ * the matrix or additional ones).
+ */
+static bool lattice_find_boundary(struct lattice* lattice) {
+    uint32_t m = lattice->dim.x*lattice->dim.y;
+    uint32_t size = 0;
+
+    for(uint32_t index = 0; index < m; index++) {
+        if(lattice->update[index] == NULL)
+            continue;
+
+        struct cell* cell = &lattice->cells[index];
+        bool boundary = false;
+        for(int k = 0; k < 4; k++)
+            if(cell->coef[k] != 0 && lattice->cells[cell->adj[k]].cond == DIRICHLET)
+                boundary = true;
+        if(!boundary)
+            continue;
+
+        if(lattice->boundaries == size) {
+            size = size ? size*2 : 256;
+            uint32_t* list = realloc(lattice->boundary, size*sizeof(uint32_t));
+            if(list == NULL)
+                return false;
+            lattice->boundary = list;
+        }
+        lattice->boundary[lattice->boundaries++] = index;
+    }
+
+    return true;
+}
+
+bool lattice_generate_function(struct lattice* lattice, edge_t func, void *ptr) {
+    /* extract the dimension of the lattice */
+    int32_t w = lattice->dim.x;
+    int32_t h = lattice->dim.y;
+
+    /* stencil edges that end on a surface between cells */
+    struct cut_list cuts = {NULL, 0, 0};
+
+    for(int32_t j = 0; j < h; j++) {
+        for(int32_t i = 0; i < w; i++) {
+            /* compute the index of the cell */
+            uint32_t index = i+j*w;
+
+            /* extract the pointer to the specified cell */
+            struct cell* cell = &lattice->cells[index];
+
+            /* we ignore neumann or dirichlet conditions */
+            if(cell->cond == NEUMANN || cell->cond == DIRICHLET) {
+                lattice->update[index] = NULL;
+                cell->coef[0] = 0;
+                cell->coef[1] = 0;
+                cell->coef[2] = 0;
+                cell->coef[3] = 0;
+                cell->extent[0] = 0;
+                cell->extent[1] = 0;
+
+                continue;
+            }
+
+            /* compute the coefficient of each stencil edge */
+            for(int k = 0; k < 4; k++)
+                cell->coef[k] = lattice_edge_coef(lattice, cell, k);
+            cell->extent[0] = 1;
+            cell->extent[1] = 1;
+
+            /* move the dirichlet surfaces to their sub-cell position */
+            if(func != NULL && !lattice_apply_edge(lattice, index, func, ptr, &cuts)) {
+                free(cuts.cuts);
+                return false;
+            }
+
+            /*
+             * a neumann border mirrors the opposite cell, so its edge
+             * is moved onto the opposite side (adjacent cells 1/2 and
+             * 3/4 are opposite to each other)
+             */
+            for(int k = 0; k < 4; k++) {
+                if(lattice->cells[cell->adj[k]].cond != NEUMANN)
+                    continue;
+
+                int opposite = k^1;
+                if(lattice->cells[cell->adj[opposite]].cond != NEUMANN) {
+                    cell->coef[opposite] *= 2;
+                    cell->extent[0] /= 2;
+                    cell->extent[1] /= 2;
+                }
+                cell->coef[k] = 0;
+            }
+
+            lattice->update[index] = &func_stencil;
+        }
+    }
+
+    /* the cells array may be moved, no cell pointers are used from here on */
+    bool success = lattice_apply_cuts(lattice, &cuts);
+    free(cuts.cuts);
+
+    return success && lattice_find_boundary(lattice);
+}
+
+/**
+ * This structure contains the part of a sum over the lattice computed
+ * by one thread.
+ */
+struct reduction {
+    struct lattice* lattice;
+    double (*func)(struct lattice*, uint32_t, uint32_t, double);
+    double value;
+    uint32_t start;
+    uint32_t end;
+    double result;
+    pthread_t thread;
+};
+
+static void* lattice_reduce_part(void* ptr) {
+    struct reduction* part = ptr;
+    part->result = part->func(part->lattice, part->start, part->end, part->value);
+    return NULL;
+}
+
+/**
+ * This function splits the work on count items into equal parts for
+ * the threads (at least min items each) and sums up the results of the
+ * parts. They are always added up in the same order, so the result
+ * does not depend on the timing.
+ */
+static double lattice_reduce(struct lattice* lattice, double (*func)(struct lattice*, uint32_t, uint32_t, double), double value, uint32_t count, uint32_t min, uint8_t threads) {
+    /* more threads than work only add overhead */
+    uint32_t n = count/min;
+    if(threads > n) threads = n;
+    if(threads < 1) threads = 1;
+
+    struct reduction parts[threads];
+    for(uint8_t t = 0; t < threads; t++) {
+        parts[t].lattice = lattice;
+        parts[t].func = func;
+        parts[t].value = value;
+        parts[t].start = (uint64_t) count*t/threads;
+        parts[t].end = (uint64_t) count*(t+1)/threads;
+        parts[t].result = 0;
+    }
+
+    /* the calling thread computes the first part */
+    uint8_t started = 1;
+    for(uint8_t t = 1; t < threads; t++) {
+        if(pthread_create(&parts[t].thread, NULL, lattice_reduce_part, &parts[t]) != 0)
+            break;
+        started++;
+    }
+    for(uint8_t t = started; t < threads; t++)
+        lattice_reduce_part(&parts[t]);
+    lattice_reduce_part(&parts[0]);
+
+    double result = 0;
+    for(uint8_t t = 0; t < threads; t++) {
+        if(t > 0 && t < started)
+            pthread_join(parts[t].thread, NULL);
+        result += parts[t].result;
+    }
+
+    return result;
+}
+
+/**
+ * This function sums up the flux from the dirichlet cells of the
+ * given conductor into a part of the boundary cells.
+ */
+static double lattice_charge_part(struct lattice* lattice, uint32_t start, uint32_t end, double conductor) {
+    double charge = 0;
+    for(uint32_t n = start; n < end; n++) {
+        struct cell* cell = &lattice->cells[lattice->boundary[n]];
+        for(int k = 0; k < 4; k++) {
+            struct cell* adj = &lattice->cells[cell->adj[k]];
+            if(adj->cond != DIRICHLET || adj->conductor != conductor)
+                continue;
+
+            /* flux from the dirichlet cell into the free cell */
+            charge += cell->coef[k]*cell->extent[k/2]*(adj->value-cell->value);
+        }
+    }
+    return charge;
+}
+
+/**
+ * This function sums up the energy of the stencil edges of a part of
+ * the cells. Edges between two free cells are shared by both.
+ */
+static double lattice_energy_part(struct lattice* lattice, uint32_t start, uint32_t end, double value) {
+    (void) value;
+    double energy = 0;
+    for(uint32_t index = start; index < end; index++) {
+        if(lattice->update[index] == NULL)
+            continue;
+
+        struct cell* cell = &lattice->cells[index];
+        for(int k = 0; k < 4; k++) {
+            uint32_t a = cell->adj[k];
+            double diff = lattice->cells[a].value-cell->value;
+            double share = lattice->update[a] == NULL ? 0.5 : 0.25;
+            energy += share*cell->coef[k]*cell->extent[k/2]*diff*diff;
+        }
+    }
+    return energy;
+}
+
+/**
+ * This function computes the field of a part of the cells and sums up
+ * its magnitude.
+ */
+static double lattice_field_part(struct lattice* lattice, uint32_t start, uint32_t end, double value) {
+    (void) value;
+    int32_t w = lattice->dim.x;
+    int32_t h = lattice->dim.y;
+    double sum = 0;
+
+    for(uint32_t index = start; index < end; index++) {
+        double* field = &lattice->field[3*index];
+        int32_t i = index%w;
+        int32_t j = index/w;
+
+        /* the outside rows and columns have no field */
+        if(i == 0 || j == 0 || i == w-1 || j == h-1) {
+            field[0] = 0;
+            field[1] = 0;
+            field[2] = 0;
+            continue;
+        }
+
+        uint32_t left = index-1, right = index+1;
+        uint32_t below = index-w, above = index+w;
+        if(lattice->cells[left].cond == NEUMANN) left = index;
+        if(lattice->cells[right].cond == NEUMANN) right = index;
+        if(lattice->cells[below].cond == NEUMANN) below = index;
+        if(lattice->cells[above].cond == NEUMANN) above = index;
+
+        double x = 0, y = 0;
+        if(right != left)
+            x = -(lattice->cells[right].value-lattice->cells[left].value)/((right-left)*lattice->step.x);
+        if(above != below)
+            y = -(lattice->cells[above].value-lattice->cells[below].value)/((above-below)/w*lattice->step.y);
+
+        field[0] = x;
+        field[1] = y;
+        field[2] = sqrt(x*x+y*y);
+        sum += field[2];
+    }
+    return sum;
+}
+
+/* smallest number of cells handled by one thread */
+#define LATTICE_REDUCE_MIN_PART 1024
+
+double lattice_charge(struct lattice* lattice, uint32_t conductor, uint8_t threads) {
+    return lattice_reduce(lattice, lattice_charge_part, conductor, lattice->boundaries, LATTICE_REDUCE_MIN_PART, threads);
+}
+
+double lattice_energy(struct lattice* lattice, uint8_t threads) {
+    return lattice_reduce(lattice, lattice_energy_part, 0, lattice->dim.x*lattice->dim.y, LATTICE_REDUCE_MIN_PART, threads);
+}
+
+bool lattice_compute_field(struct lattice* lattice, uint8_t threads) {
+    uint32_t m = lattice->dim.x*lattice->dim.y;
+
+    if(lattice->field == NULL) {
+        lattice->field = malloc(3*m*sizeof(double));
+        if(lattice->field == NULL)
+            return false;
+    }
+
+    double sum = lattice_reduce(lattice, lattice_field_part, 0, m, LATTICE_REDUCE_MIN_PART, threads);
+    lattice->field_mean = sum/m;
+
+    return true;
+}
+
+uint32_t lattice_compute(struct lattice* lattice, double threshold) {
+    uint32_t iterations = 0;
+
+    /* apply iterations until the threshold is bigger */
+    while(lattice_iterate(lattice) > threshold)
+        iterations++;
+
+    return iterations;
+}
+
+double lattice_iterate(struct lattice* lattice) {
+    /* extract the dimension of the lattice */
+    int32_t w = lattice->dim.x;
+    int32_t h = lattice->dim.y;
+
+    /* the largest difference */
+    double diff = 0;
+
+    for(int32_t j = 0; j < h; j++) {
+        for(int32_t i = 0; i < w; i++) {
+            /* compute the index of the cell */
+            uint32_t index = i+j*w;
+            double value, check;
+
+            /* extract the pointer to the specified cell */
+            struct cell* cell = &lattice->cells[index];
+
+            /* make sure the cell can be updated */
+            if(lattice->update[index] == NULL)
+                continue;
+
+            /* compute the new value */
+            value = (*lattice->update[index])(lattice, cell);
+            check = fabs(value-cell->value);
+            if(check > diff) diff = check;
+
+            /* update the cell */
+            cell->value = value;
+        }
+    }
+
+    return diff;
+}
+
+uint32_t lattice_compute_threaded(struct lattice* lattice, struct config* conf, progress_callback_t cb, quantity_callback_t quantity, void *cb_ptr) {
+    struct worker* worker;
+    struct worker* next;
+    uint32_t iterations = 0;
+
+    if(conf->method != METHOD_GAUSS_SEIDEL)
+        return engine_compute(lattice, conf, cb, quantity, cb_ptr);
+
+    /* create the first worker and wait */
+    worker = worker_new(NULL, lattice, conf, cb, cb_ptr);
+    pthread_join(worker->thread, NULL);
+
+    /* traver the linked list */
+    next = worker->next;
+    worker->next = NULL;
+    while(next != NULL) {
+        /* count the total number of iterations */
+        iterations += next->iterations;
+
+        /* free the workers */
+        next = next->next;
+        if(next != NULL)
+           worker_delete(next->previous);
+    }
+
+    /* free the last worker */
+    worker_delete(worker);
+
+    return iterations;
+}
@@ -0,0 +1,443 @@
+#ifndef INCLUDE_LATTICE_H
+#define INCLUDE_LATTICE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "tuple.h"
+#include "worker.h"
+#include "monitor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * This enumeration defines the possible conditions that
+ * can be applied to the problem.
+ */
+enum condition {
+    UNSET,
+    NONE,
+    NEUMANN,
+    DIRICHLET,
+};
+
+/**
+ * This enumeration defines how the weights of two adjacent cells
+ * are combined into the coefficient of the stencil edge between them.
+ * When averaging, edges towards dirichlet cells only use the weight of
+ * the free cell, there is no field inside the conductors.
+ */
+enum averaging {
+    /**
+     * The coefficient is the product of both weights. The weight of
+     * the cell itself cancels in its update, which then only depends
+     * on the weights of the adjacent cells, but both cells see the
+     * same coefficient on their common edge (e.g. the geometric mean
+     * if the weights are square roots).
+     */
+    AVERAGING_NONE,
+    /**
+     * The coefficient is the arithmetic mean of both weights.
+     */
+    AVERAGING_ARITHMETIC,
+    /**
+     * The coefficient is the harmonic mean of both weights.
+     */
+    AVERAGING_HARMONIC,
+};
+
+/**
+ * This structure represent a cell in the matrix.
+ */
+struct cell {
+    /**
+     * This is the position of the cell in space.
+     */
+    struct rect pos;
+    /**
+     * This is the index position of the cell in the matrix.
+     */
+    struct point index;
+    /**
+     * This is the current value contained in the cell.
+     */
+    double value;
+    /**
+     * This is the condition applied to this cell.
+     */
+    enum condition cond;
+    /**
+     * This is the number of the conductor a dirichlet cell belongs to,
+     * 0 for ground and all other cells.
+     */
+    uint32_t conductor;
+    /**
+     * This is the weight applied to this cell.
+     */
+    double weight;
+    /**
+     * These are the coefficients of the stencil edges towards the
+     * four adjacent cells. Mirrored neumann borders are already
+     * folded into these coefficients.
+     */
+    double coef[4];
+    /**
+     * These are the factors converting the coefficients of the stencil
+     * edges along each axis (adjacent cells 1/2 and 3/4) into the flux
+     * through the cell face per potential difference. They are the area
+     * of the control volume around the cell (in cell areas), shortened
+     * by the Shortley-Weller distances on both axes and halved at
+     * mirrored neumann borders.
+     */
+    double extent[2];
+    /**
+     * These are the indexes of the four adjacent cells.
+     *
+     *      [ ] [1] [ ]
+     *      [3] [x] [4]
+     *      [ ] [2] [ ]
+     *
+     */
+    uint32_t adj[4];
+    /**
+     * These are the indexes of the four diagonal cells.
+     *
+     *      [4] [ ] [1]
+     *      [ ] [x] [ ]
+     *      [3] [ ] [2]
+     *
+     */
+    uint32_t diag[4];
+};
+
+typedef double (*weight_t)(void *ptr, struct rect*);
+
+/**
+ * This structure represent the entire matrix used for
+ * solving the laplace equation with conditions.
+ */
+struct lattice {
+    /**
+     * This contains the size of the matrix.
+     */
+    struct point dim;
+    /**
+     * This contains the spacing between two cells in each direction.
+     */
+    struct rect step;
+    /**
+     * This is the actual matrix of cell.
+     */
+    struct cell* cells;
+    /**
+     * This is the matrix containing all the update functions
+     * for each of the cell.
+     */
+    double (**update)(struct lattice*, struct cell*);
+    /**
+     * This is the number of additional dirichlet cells stored after
+     * the matrix. They represent surfaces located between cells.
+     */
+    uint32_t ghosts;
+    /**
+     * These are the indexes of the free cells with at least one
+     * dirichlet cell in their stencil, the charge of the conductors is
+     * extracted from them.
+     */
+    uint32_t* boundary;
+    uint32_t boundaries;
+    /**
+     * This is the electric field of each cell in the matrix (x, y and
+     * magnitude, three values per cell), @{code NULL} until it has been
+     * computed with lattice_compute_field.
+     */
+    double* field;
+    /**
+     * This is the mean magnitude of the field over all cells.
+     */
+    double field_mean;
+    /**
+     * This is the averaging used for the stencil coefficients.
+     */
+    enum averaging averaging;
+    /**
+     * Set this to true if all threads should abort their calculation as soon as possible
+     */
+    bool abort;
+    /**
+     * This is set (together with abort) if the computation stopped
+     * because it stagnated or diverged.
+     */
+    enum result result;
+    /**
+     * This is the smallest difference reached before it stopped.
+     */
+    double reached;
+};
+
+/**
+ * This structure contains the conditions returned by the
+ * boundaries function.
+ */
+struct bound {
+    /**
+     * This contains the value of the cell.
+     */
+    double value;
+    /**
+     * This contains the condition applied to the cell.
+     */
+    enum condition cond;
+    /**
+     * This contains the number of the conductor (dirichlet only).
+     */
+    uint32_t conductor;
+};
+
+/**
+ * This is the definition of the boundaries function. During the
+ * creation of the lattice, this function is called for each cell.
+ * This allows the user to define custom boundary conditions for
+ * each individual cells.
+ *
+ * Only the spatial position of the cell is needed for defining the
+ * boundary conditions. This function must returns the same structure
+ * that has been passed in argument.
+ */
+typedef struct bound* (*bound_t)(void *ptr, struct bound*, struct rect*);
+
+/**
+ * This structure contains the dirichlet surface returned by the
+ * edge function.
+ */
+struct edge {
+    /**
+     * This is the position of the surface along the stencil edge as
+     * a fraction of the cell spacing, measured from the free cell.
+     */
+    double fraction;
+    /**
+     * This contains the value of the surface.
+     */
+    double value;
+    /**
+     * This is DIRICHLET if a surface crosses the stencil edge.
+     */
+    enum condition cond;
+    /**
+     * This contains the number of the conductor of the surface.
+     */
+    uint32_t conductor;
+};
+
+/**
+ * This is the definition of the edge function. During the creation
+ * of the lattice, this function is called for each stencil edge that
+ * starts at a free cell. The structure is prefilled with the adjacent
+ * cell (fraction 1.0, its value and condition) and the function must
+ * return it, updated with the closest dirichlet surface crossing the
+ * edge (0 < fraction <= 1).
+ *
+ * The stencil of the free cell is then modified (Shortley-Weller) so
+ * that the boundary condition applies at its true sub-cell position.
+ * Surfaces between two free cells (e.g. conductors without thickness)
+ * are connected to additional dirichlet cells after the matrix.
+ */
+typedef struct edge* (*edge_t)(void *ptr, struct edge*, struct rect* from, struct rect* to);
+
+/**
+ * This function creates a lattice ready to be computed. It first
+ * starts by allocating memory and appliying the boundary function.
+ * After this step, it will generate a function that will update each
+ * cell based on the adjacent cells.
+ *
+ * Be warned that the final matrix contains 2 more columns and rows
+ * in order to facilitate the computing. These added cells won't be
+ * sent to the boundary function.
+ *
+ * @param size
+ *        This rectangle represents the spatial size of the problem.
+ * @param dim
+ *        This point represents the resolution of the matrix. The cell
+ *        spacing may be different for both directions, the stencil is
+ *        weighted accordingly.
+ * @param func
+ *        This is a pointer to the boundary function.
+ * @param w_func
+ *        This is a pointer to the weight function.
+ * @param averaging
+ *        This defines how the weights of adjacent cells are combined
+ *        into the stencil coefficients.
+ * @param e_func
+ *        This is a pointer to the edge function. If @{code NULL},
+ *        dirichlet surfaces are located on the cells themselves.
+ *
+ * @return The pointer to the new lattice if everyhthing went as
+ *         expected, else @{code NULL} value.
+ */
+struct lattice* lattice_new(struct rect* size, struct point* dim, bound_t func, weight_t w_func, enum averaging averaging, edge_t e_func, void *ptr);
+
+/**
+ * This function frees the memory of a lattice.
+ *
+ * @param lattice
+ *        This is a pointer to the lattice to free.
+ */
+void lattice_delete(struct lattice* lattice);
+
+/**
+ * This function initialises the free cells of a lattice with the
+ * potential of an other lattice covering the same area, e.g. a
+ * previous solution on a different grid. The values are bilinearly
+ * interpolated, a good initial value saves many iterations.
+ *
+ * @param lattice
+ *        This is a pointer to the lattice to initialise.
+ * @param from
+ *        This is a pointer to the lattice containing the potential.
+ */
+void lattice_interpolate(struct lattice* lattice, struct lattice* from);
+
+/**
+ * This function resets all free cells to zero and clears the abort
+ * request and the result, e.g. to restart a diverged computation.
+ *
+ * @param lattice
+ *        This is a pointer to the lattice.
+ */
+void lattice_reset(struct lattice* lattice);
+
+/**
+ * This function creates an independent copy of a lattice, e.g. to
+ * solve several excitations of the same geometry. The field is not
+ * copied.
+ *
+ * @param lattice
+ *        This is a pointer to the lattice to copy.
+ *
+ * @return The pointer to the new lattice if everyhthing went as
+ *         expected, else @{code NULL} value.
+ */
+struct lattice* lattice_copy(struct lattice* lattice);
+
+/**
+ * This function sets the potential of every conductor and resets all
+ * free cells to zero.
+ *
+ * @param lattice
+ *        This is a pointer to the lattice.
+ * @param potentials
+ *        These are the potentials indexed by the conductor number.
+ * @param count
+ *        This is the number of potentials, conductors with a higher
+ *        number are set to zero.
+ */
+void lattice_excite(struct lattice* lattice, const double* potentials, uint32_t count);
+
+/**
+ * This function computes the charge of all dirichlet cells of the
+ * given conductor from the stencils of the adjacent free cells. The flux
+ * from the dirichlet cells into the free cells is the residual the
+ * stencil would have at the dirichlet cells, so the result is
+ * consistent with the discretisation and needs no integration path.
+ * Only the free cells next to dirichlet cells are visited, split
+ * across the threads.
+ *
+ * @param lattice
+ *        This is a pointer to the lattice.
+ * @param conductor
+ *        This is the number of the conductor (0 for ground).
+ * @param threads
+ *        This is the number of threads to use.
+ *
+ * @return The charge divided by the vacuum permittivity, per unit
+ *         length of the problem.
+ */
+double lattice_charge(struct lattice* lattice, uint32_t conductor, uint8_t threads);
+
+/**
+ * This function computes the energy stored in the field, the sum of
+ * the flux coefficient times diff^2/2 over all stencil edges (edges
+ * between two free cells use the mean of both coefficients). With the
+ * conductors at the potentials V, twice the energy is the sum of Q*V,
+ * so this is an independent estimate of the capacitance (C = 2W/V^2)
+ * that does not only depend on the cells next to the conductors. The
+ * cells are split across the threads.
+ *
+ * This is exact for a symmetric stencil. The Shortley-Weller stencil
+ * of cells next to sub-cell surfaces is not, its coefficients towards
+ * the other free cells differ from theirs. The energy then deviates
+ * from the sum of Q*V by a few percent.
+ *
+ * @param lattice
+ *        This is a pointer to the lattice.
+ * @param threads
+ *        This is the number of threads to use.
+ *
+ * @return The energy divided by the vacuum permittivity, per unit
+ *         length of the problem.
+ */
+double lattice_energy(struct lattice* lattice, uint8_t threads);
+
+/**
+ * This function computes the electric field of all cells from the
+ * central differences of the potential (one sided next to neumann
+ * borders), once the computation is done. Everything that needs the
+ * field reads it from this map instead of differentiating again. The
+ * cells are split across the threads.
+ *
+ * @param lattice
+ *        This is a pointer to the lattice.
+ * @param threads
+ *        This is the number of threads to use.
+ *
+ * @return True if the field could be allocated.
+ */
+bool lattice_compute_field(struct lattice* lattice, uint8_t threads);
+
+/**
+ * This function prints the value of each cell inside a lattice.
+ *
+ * @param lattice
+ *        This is a pointer to the lattice to free.
+ */
+void lattice_print(struct lattice* lattice);
+
+/**
+ * This function computes the laplace equation sequentially for a
+ * given lattice.
+ *
+ * @param lattice
+ *        This is a pointer to the lattice.
+ * @param threshold
+ *        This is the threhold used to stop the computation.
+ *
+ * @return The number of iterations.
+ */
+uint32_t lattice_compute(struct lattice* lattice, double threshold);
+
+/**
+ * This function computes the laplace equation in parrallel for a
+ * given lattice. The number of iteration might varies from one
+ * execution to an other.
+ *
+ * The pipelined gauss-seidel workers are used unless the
+ * configuration selects an other method.
+ * The quantity of interest is only evaluated by the other methods.
+ *
+ * @param lattice
+ *        This is a pointer to the lattice.
+ * @param conf
+ *        This is a pointer the configuration of the computation.
+ *
+ * @return The number of iterations.
+ */
+uint32_t lattice_compute_threaded(struct lattice* lattice, struct config* conf, progress_callback_t cb, quantity_callback_t quantity, void *cb_ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,43 @@
+#include "matrix.h"
+
+#include <cmath>
+#include <utility>
+
+std::vector<std::vector<double>> Matrix::invert(std::vector<std::vector<double>> m)
+{
+    int n = m.size();
+    std::vector<std::vector<double>> inv(n, std::vector<double>(n, 0));
+    for(int i=0;i<n;i++) {
+        inv[i][i] = 1.0;
+    }
+    for(int col=0;col<n;col++) {
+        // use the largest remaining element of this column as the pivot
+        int pivot = col;
+        for(int row=col+1;row<n;row++) {
+            if(std::abs(m[row][col]) > std::abs(m[pivot][col])) {
+                pivot = row;
+            }
+        }
+        if(m[pivot][col] == 0 || !std::isfinite(m[pivot][col])) {
+            return std::vector<std::vector<double>>();
+        }
+        std::swap(m[col], m[pivot]);
+        std::swap(inv[col], inv[pivot]);
+        double scale = 1.0 / m[col][col];
+        for(int k=0;k<n;k++) {
+            m[col][k] *= scale;
+            inv[col][k] *= scale;
+        }
+        for(int row=0;row<n;row++) {
+            if(row == col || m[row][col] == 0) {
+                continue;
+            }
+            double factor = m[row][col];
+            for(int k=0;k<n;k++) {
+                m[row][k] -= factor * m[col][k];
+                inv[row][k] -= factor * inv[col][k];
+            }
+        }
+    }
+    return inv;
+}
@@ -0,0 +1,13 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <vector>
+
+namespace Matrix {
+
+    // inverse of a square matrix (gaussian elimination with partial pivoting), empty if it is singular
+    std::vector<std::vector<double>> invert(std::vector<std::vector<double>> m);
+
+}
+
+#endif // MATRIX_H
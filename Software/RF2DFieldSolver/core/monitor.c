@@ -0,0 +1,42 @@
+#include <math.h>
+
+#include "monitor.h"
+
+/* the smallest difference has to improve by this factor within the window */
+#define MONITOR_PROGRESS 0.9
+/* minimum number of iterations without progress before giving up */
+#define MONITOR_MIN_WINDOW 500
+/* a difference this much larger than the smallest one means divergence */
+#define MONITOR_DIVERGENCE 1e4
+
+void monitor_init(struct monitor* monitor) {
+    monitor->best = INFINITY;
+    monitor->reference = INFINITY;
+    monitor->start = 0;
+    monitor->iterations = 0;
+}
+
+enum result monitor_update(struct monitor* monitor, double diff) {
+    monitor->iterations++;
+
+    if(!isfinite(diff) || diff > monitor->best*MONITOR_DIVERGENCE)
+        return RESULT_DIVERGED;
+
+    if(diff < monitor->best)
+        monitor->best = diff;
+
+    /* start a new window whenever there was enough progress */
+    if(monitor->best < monitor->reference*MONITOR_PROGRESS) {
+        monitor->reference = monitor->best;
+        monitor->start = monitor->iterations;
+        return RESULT_NONE;
+    }
+
+    uint32_t window = monitor->iterations/2;
+    if(window < MONITOR_MIN_WINDOW)
+        window = MONITOR_MIN_WINDOW;
+    if(monitor->iterations-monitor->start > window)
+        return RESULT_STAGNATED;
+
+    return RESULT_NONE;
+}
@@ -0,0 +1,73 @@
+#ifndef INCLUDE_MONITOR_H
+#define INCLUDE_MONITOR_H
+
+#include <stdint.h>
+
+/**
+ * This enumeration defines the state of a computation as seen by the
+ * monitor.
+ */
+enum result {
+    /**
+     * The differences are still going down.
+     */
+    RESULT_NONE,
+    /**
+     * The differences stopped going down before reaching the
+     * threshold (e.g. limited by the floating point precision).
+     */
+    RESULT_STAGNATED,
+    /**
+     * The differences are growing without bound.
+     */
+    RESULT_DIVERGED,
+};
+
+/**
+ * This structure watches the differences of consecutive iterations.
+ * Convergence is considered stagnated if the smallest difference did
+ * not improve noticeably within a window that grows with the number
+ * of iterations. Very slow convergence looks the same, the caller
+ * decides from the reached difference whether to continue.
+ */
+struct monitor {
+    /**
+     * This is the smallest difference seen so far.
+     */
+    double best;
+    /**
+     * This is the smallest difference at the start of the window.
+     */
+    double reference;
+    /**
+     * This is the iteration at the start of the window.
+     */
+    uint32_t start;
+    /**
+     * This is the number of iterations seen so far.
+     */
+    uint32_t iterations;
+};
+
+/**
+ * This function initialises a monitor.
+ *
+ * @param monitor
+ *        This is a pointer to the monitor.
+ */
+void monitor_init(struct monitor* monitor);
+
+/**
+ * This function updates the monitor with the difference of the last
+ * iteration.
+ *
+ * @param monitor
+ *        This is a pointer to the monitor.
+ * @param diff
+ *        This is the largest difference of the last iteration.
+ *
+ * @return The state of the computation.
+ */
+enum result monitor_update(struct monitor* monitor, double diff);
+
+#endif
@@ -0,0 +1,416 @@
+#include "polygon.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+enum class Intersection {
+    None,
+    Unbounded,
+    Bounded,
+};
+
+// intersection of the lines through a1, a2 and b1, b2, bounded if it lies on both segments (same as QLineF::intersects)
+Intersection lineIntersection(const Point &a1, const Point &a2, const Point &b1, const Point &b2, Point *point)
+{
+    auto a = a2 - a1;
+    auto b = b1 - b2;
+    auto c = a1 - b1;
+    double denominator = a.y * b.x - a.x * b.y;
+    if(denominator == 0 || !std::isfinite(denominator)) {
+        return Intersection::None;
+    }
+    double reciprocal = 1 / denominator;
+    double na = (b.y * c.x - b.x * c.y) * reciprocal;
+    if(point) {
+        *point = a1 + a * na;
+    }
+    if(na < 0 || na > 1) {
+        return Intersection::Unbounded;
+    }
+    double nb = (a.x * c.y - a.y * c.x) * reciprocal;
+    if(nb < 0 || nb > 1) {
+        return Intersection::Unbounded;
+    }
+    return Intersection::Bounded;
+}
+
+double length(const Point &p)
+{
+    return sqrt(Point::dotProduct(p, p));
+}
+
+double cross(const Point &a, const Point &b)
+{
+    return a.x * b.y - a.y * b.x;
+}
+
+// true if the segments p1-p2 and q1-q2 have at least one point in common
+bool segmentsTouch(const Point &p1, const Point &p2, const Point &q1, const Point &q2)
+{
+    auto onSegment = [](const Point &a, const Point &b, const Point &p) -> bool {
+        return p.x >= std::min(a.x, b.x) && p.x <= std::max(a.x, b.x) && p.y >= std::min(a.y, b.y) && p.y <= std::max(a.y, b.y);
+    };
+    double d1 = cross(q2 - q1, p1 - q1);
+    double d2 = cross(q2 - q1, p2 - q1);
+    double d3 = cross(p2 - p1, q1 - p1);
+    double d4 = cross(p2 - p1, q2 - p1);
+    if(((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0))) {
+        return true;
+    }
+    return (d1 == 0 && onSegment(q1, q2, p1)) || (d2 == 0 && onSegment(q1, q2, p2))
+            || (d3 == 0 && onSegment(p1, p2, q1)) || (d4 == 0 && onSegment(p1, p2, q2));
+}
+
+// counter-clockwise copy of the polygon
+std::vector<Point> counterClockwise(const std::vector<Point> &vertices)
+{
+    auto ret = vertices;
+    if(Polygon::isClockwise(ret)) {
+        std::reverse(ret.begin(), ret.end());
+    }
+    return ret;
+}
+
+// Contribution of the outline of a that lies inside of b to the area of the overlap (Green's theorem, both counter-clockwise).
+// Parts on the outline of b only count half, the other half (or the opposite part that cancels it) comes from the outline of b
+double overlapContribution(const std::vector<Point> &a, const std::vector<Point> &b, double tolerance)
+{
+    double sum = 0;
+    for(unsigned int i=0;i<a.size();i++) {
+        auto p1 = a[i];
+        auto p2 = a[(i+1) % a.size()];
+        auto d = p2 - p1;
+        double len = length(d);
+        if(len == 0) {
+            continue;
+        }
+        // split the edge at every point where it meets the outline of b
+        std::vector<double> splits = {0.0, 1.0};
+        for(unsigned int j=0;j<b.size();j++) {
+            auto q1 = b[j];
+            auto q2 = b[(j+1) % b.size()];
+            Point point;
+            if(lineIntersection(p1, p2, q1, q2, &point) == Intersection::Bounded) {
+                splits.push_back(Point::dotProduct(point - p1, d) / (len * len));
+            }
+            // vertices of b on this edge (e.g. collinear edges)
+            for(auto &q : {q1, q2}) {
+                if(Polygon::distanceToLine(q, p1, p2) <= tolerance) {
+                    splits.push_back(Point::dotProduct(q - p1, d) / (len * len));
+                }
+            }
+        }
+        for(auto &t : splits) {
+            t = std::clamp(t, 0.0, 1.0);
+        }
+        std::sort(splits.begin(), splits.end());
+        for(unsigned int k=1;k<splits.size();k++) {
+            if(splits[k] <= splits[k-1]) {
+                continue;
+            }
+            auto start = p1 + d * splits[k-1];
+            auto end = p1 + d * splits[k];
+            auto middle = (start + end) * 0.5;
+            bool onOutline = false;
+            for(unsigned int j=0;j<b.size() && !onOutline;j++) {
+                onOutline = Polygon::distanceToLine(middle, b[j], b[(j+1) % b.size()]) <= tolerance;
+            }
+            double weight = onOutline ? 0.5 : Polygon::contains(b, middle) ? 1.0 : 0.0;
+            sum += weight * cross(start, end) / 2;
+        }
+    }
+    return sum;
+}
+
+}
+
+bool Polygon::selfIntersects(const std::vector<Point> &vertices)
+{
+    for(int i=0;i<(int) vertices.size();i++) {
+        int prev = i-1;
+        if(prev < 0) {
+            prev = vertices.size() - 1;
+        }
+        auto p0 = vertices[prev];
+        auto p1 = vertices[i];
+        for(int j=i+1;j<(int) vertices.size();j++) {
+            int prev = j-1;
+            if(prev < 0) {
+                prev = vertices.size() - 1;
+            }
+            auto p2 = vertices[prev];
+            auto p3 = vertices[j];
+            Point intersectPoint;
+            auto intersect = lineIntersection(p0, p1, p2, p3, &intersectPoint);
+            if(intersect == Intersection::Bounded) {
+                // we have an intersection. Check whether we are checking consecutive lines and the intersect point is the common vertex
+                if(j == i+1 || (i==0 && j==(int) vertices.size() - 1)) {
+                    Point common, pl1, pl2;
+                    if(j == i+1) {
+                        common = p1;
+                        pl1 = p0;
+                        pl2 = p3;
+                    } else {
+                        common = p3;
+                        pl1 = p1;
+                        pl2 = p2;
+                    }
+                    auto commonIntersectDist = length(intersectPoint - common);
+                    auto pl1IntersectDist = length(intersectPoint - pl1);
+                    auto pl2IntersectDist = length(intersectPoint - pl2);
+                    if(commonIntersectDist < pl1IntersectDist && commonIntersectDist < pl2IntersectDist) {
+                        // ignore, this is not a real intersection
+                        continue;
+                    }
+                }
+                // real intersection
+                return true;
+            }
+        }
+    }
+    // no intersection found
+    return false;
+}
+
+
+std::vector<Point> Polygon::offset(const std::vector<Point> &vertices, double offset)
+{
+    std::vector<Point> ret;
+    if (vertices.size() < 3) {
+        // unable to offset
+        return vertices;
+    }
+
+    if (isClockwise(vertices)) {
+        // CW polygon, invert offset
+        offset = -offset;
+    }
+    // shift a line along its normal vector
+    auto translate = [=](Point &p1, Point &p2) {
+        auto d = p2 - p1;
+        double len = length(d);
+        if(len > 0) {
+            auto shift = Point(d.y, -d.x) * (offset / len);
+            p1 += shift;
+            p2 += shift;
+        }
+    };
+    // offset lines and create new points at the intersect points:
+    // https://stackoverflow.com/questions/69600158/draw-a-second-identical-polygon-inside-a-primary-one-with-a-certain-gap
+    for(unsigned int i = 0;i<vertices.size();i++) {
+        auto pp = vertices[(i+vertices.size()-1) % vertices.size()];
+        auto pc = vertices[i];
+        auto pn = vertices[(i+vertices.size()+1) % vertices.size()];
+
+        auto a1 = pp, a2 = pc;
+        translate(a1, a2);
+        auto b1 = pc, b2 = pn;
+        translate(b1, b2);
+
+        Point point;
+        auto intersect = lineIntersection(a1, a2, b1, b2, &point);
+        if (intersect != Intersection::None) {
+            ret.push_back(point);
+        }
+    }
+    return ret;
+}
+
+bool Polygon::isClockwise(const std::vector<Point> &vertices)
+{
+    // determine winding direction of polygon:
+    // https://stackoverflow.com/questions/1165647/how-to-determine-if-a-list-of-polygon-points-are-in-clockwise-order
+    double edgeSum = 0;
+    for(unsigned int i = 0;i<vertices.size();i++) {
+        auto pp = vertices[(i+vertices.size()-1) % vertices.size()];
+        auto pc = vertices[i];
+        edgeSum += (pc.x - pp.x)*(pc.y + pp.y);
+    }
+    return edgeSum > 0;
+}
+
+double Polygon::area(const std::vector<Point> &vertices)
+{
+    // shoelace formula, independent of winding direction
+    double sum = 0;
+    for(unsigned int i = 0;i<vertices.size();i++) {
+        auto pp = vertices[(i+vertices.size()-1) % vertices.size()];
+        auto pc = vertices[i];
+        sum += pp.x * pc.y - pc.x * pp.y;
+    }
+    return std::abs(sum / 2);
+}
+
+double Polygon::intersectionArea(const std::vector<Point> &vertices, const Rect &rect)
+{
+    auto r = Rect(Point(std::min(rect.min.x, rect.max.x), std::min(rect.min.y, rect.max.y)),
+                  Point(std::max(rect.min.x, rect.max.x), std::max(rect.min.y, rect.max.y)));
+    if(vertices.size() < 3) {
+        return 0;
+    }
+    // quick check whether the bounding boxes overlap at all
+    auto b = bounds(vertices);
+    if(b.min.x >= r.max.x || b.max.x <= r.min.x || b.min.y >= r.max.y || b.max.y <= r.min.y) {
+        return 0;
+    }
+    if(b.min.x >= r.min.x && b.max.x <= r.max.x && b.min.y >= r.min.y && b.max.y <= r.max.y) {
+        // polygon completely inside of the rectangle
+        return area(vertices);
+    }
+
+    // clip the polygon against each edge of the rectangle (Sutherland-Hodgman). For
+    // concave polygons this may leave degenerate zero-width edges but the area is still correct
+    std::vector<Point> clipped = vertices;
+    for(unsigned int edge=0;edge<4;edge++) {
+        auto inside = [&](const Point &p) -> bool {
+            switch(edge) {
+            case 0: return p.x >= r.min.x;
+            case 1: return p.x <= r.max.x;
+            case 2: return p.y >= r.min.y;
+            default: return p.y <= r.max.y;
+            }
+        };
+        auto intersect = [&](const Point &p1, const Point &p2) -> Point {
+            double t;
+            switch(edge) {
+            case 0: t = (r.min.x - p1.x) / (p2.x - p1.x); break;
+            case 1: t = (r.max.x - p1.x) / (p2.x - p1.x); break;
+            case 2: t = (r.min.y - p1.y) / (p2.y - p1.y); break;
+            default: t = (r.max.y - p1.y) / (p2.y - p1.y); break;
+            }
+            return p1 + (p2 - p1) * t;
+        };
+        std::vector<Point> input = clipped;
+        clipped.clear();
+        for(unsigned int i=0;i<input.size();i++) {
+            auto pp = input[(i+input.size()-1) % input.size()];
+            auto pc = input[i];
+            if(inside(pc)) {
+                if(!inside(pp)) {
+                    clipped.push_back(intersect(pp, pc));
+                }
+                clipped.push_back(pc);
+            } else if(inside(pp)) {
+                clipped.push_back(intersect(pp, pc));
+            }
+        }
+        if(clipped.size() < 3) {
+            return 0;
+        }
+    }
+    return area(clipped);
+}
+
+double Polygon::firstIntersection(const std::vector<Point> &vertices, const Point &p1, const Point &p2, bool closed)
+{
+    double first = -1;
+    auto d = p2 - p1;
+    for(unsigned int i = 0;i<vertices.size();i++) {
+        if(i == 0 && !closed) {
+            continue;
+        }
+        auto pp = vertices[(i+vertices.size()-1) % vertices.size()];
+        auto pc = vertices[i];
+        auto e = pc - pp;
+        double denom = d.x * e.y - d.y * e.x;
+        if(denom == 0) {
+            // parallel, no single crossing point
+            continue;
+        }
+        auto w = pp - p1;
+        // position along our line and along the polygon edge
+        double t = (w.x * e.y - w.y * e.x) / denom;
+        double u = (w.x * d.y - w.y * d.x) / denom;
+        if(t < 0 || t > 1 || u < 0 || u > 1) {
+            continue;
+        }
+        if(first < 0 || t < first) {
+            first = t;
+        }
+    }
+    return first;
+}
+
+bool Polygon::contains(const std::vector<Point> &vertices, const Point &p)
+{
+    int crossings = 0;
+    for(unsigned int i = 0;i<vertices.size();i++) {
+        auto p1 = vertices[(i+vertices.size()-1) % vertices.size()];
+        auto p2 = vertices[i];
+        if(std::abs(p1.y - p2.y) * 1e12 <= std::min(std::abs(p1.y), std::abs(p2.y))) {
+            // ignore horizontal edges according to the scan conversion rule
+            continue;
+        }
+        if(p2.y < p1.y) {
+            std::swap(p1, p2);
+        }
+        if(p.y >= p1.y && p.y < p2.y) {
+            double x = p1.x + ((p2.x - p1.x) / (p2.y - p1.y)) * (p.y - p1.y);
+            if(x <= p.x) {
+                crossings++;
+            }
+        }
+    }
+    return crossings % 2;
+}
+
+bool Polygon::intersects(const std::vector<Point> &a, const std::vector<Point> &b)
+{
+    if(a.empty() || b.empty()) {
+        return false;
+    }
+    for(unsigned int i=0;i<a.size();i++) {
+        for(unsigned int j=0;j<b.size();j++) {
+            if(segmentsTouch(a[i], a[(i+1) % a.size()], b[j], b[(j+1) % b.size()])) {
+                return true;
+            }
+        }
+    }
+    // the outlines are apart, one can only be completely inside of the other
+    return contains(b, a[0]) || contains(a, b[0]);
+}
+
+double Polygon::overlapArea(const std::vector<Point> &a, const std::vector<Point> &b)
+{
+    if(a.size() < 3 || b.size() < 3 || !intersects(a, b)) {
+        return 0;
+    }
+    auto ba = bounds(a);
+    auto bb = bounds(b);
+    double size = std::max({ba.width(), ba.height(), bb.width(), bb.height()});
+    double tolerance = size * 1e-12;
+    auto ccwA = counterClockwise(a);
+    auto ccwB = counterClockwise(b);
+    double sum = overlapContribution(ccwA, ccwB, tolerance) + overlapContribution(ccwB, ccwA, tolerance);
+    // only rounding errors are left if they just touch
+    if(sum <= std::min(area(a), area(b)) * 1e-9) {
+        return 0;
+    }
+    return sum;
+}
+
+double Polygon::distanceToLine(const Point &point, const Point &l1, const Point &l2)
+{
+    auto M = l2 - l1;
+    double divisor = Point::dotProduct(M, M);
+    double t0 = divisor > 0 ? Point::dotProduct(M, point - l1) / divisor : 0;
+    t0 = std::clamp(t0, 0.0, 1.0);
+    return length(point - (l1 + M * t0));
+}
+
+Rect Polygon::bounds(const std::vector<Point> &vertices)
+{
+    if(vertices.empty()) {
+        return Rect();
+    }
+    Rect r(vertices[0], vertices[0]);
+    for(auto &v : vertices) {
+        r.min.x = std::min(r.min.x, v.x);
+        r.max.x = std::max(r.max.x, v.x);
+        r.min.y = std::min(r.min.y, v.y);
+        r.max.y = std::max(r.max.y, v.y);
+    }
+    return r;
+}
@@ -0,0 +1,31 @@
+#ifndef POLYGON_H
+#define POLYGON_H
+
+#include "geometry.h"
+
+#include <vector>
+
+namespace Polygon {
+
+    bool selfIntersects(const std::vector<Point> &vertices);
+    std::vector<Point> offset(const std::vector<Point> &vertices, double offset);
+    bool isClockwise(const std::vector<Point> &vertices);
+    double area(const std::vector<Point> &vertices);
+    // area of the part of the polygon that lies inside of rect
+    double intersectionArea(const std::vector<Point> &vertices, const Rect &rect);
+    // position of the first crossing of the polygon outline along the line from p1 to p2 (0.0 at p1, 1.0 at p2), -1 if not crossed.
+    // If closed is false, the vertices form an open polyline without a connection from the last to the first vertex
+    double firstIntersection(const std::vector<Point> &vertices, const Point &p1, const Point &p2, bool closed = true);
+    // odd-even rule, points on the left and bottom edges are inside (same scan conversion rule as QPolygonF::containsPoint)
+    bool contains(const std::vector<Point> &vertices, const Point &p);
+    // true if the outlines touch or cross, or one polygon is inside the other
+    bool intersects(const std::vector<Point> &a, const std::vector<Point> &b);
+    // area of the overlap of two polygons, zero if they only touch
+    double overlapArea(const std::vector<Point> &a, const std::vector<Point> &b);
+    double distanceToLine(const Point &point, const Point &l1, const Point &l2);
+    // bounding box of the vertices
+    Rect bounds(const std::vector<Point> &vertices);
+
+}
+
+#endif // POLYGON_H
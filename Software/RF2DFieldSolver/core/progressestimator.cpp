@@ -0,0 +1,88 @@
+#include "progressestimator.h"
+
+#include <cmath>
+
+// at least this many samples are needed for a fit
+constexpr unsigned int minSamples = 3;
+// samples older than this fraction of the iterations are not used for the fit,
+// the convergence is usually faster at the beginning than later on
+constexpr double fitWindow = 0.5;
+
+ProgressEstimator::ProgressEstimator()
+{
+    reset(1e-6);
+}
+
+void ProgressEstimator::reset(double threshold)
+{
+    samples.clear();
+    logThreshold = log(threshold);
+    percent = 0;
+    remainingTime = -1;
+    remainingIterations = -1;
+    rate = 1.0;
+}
+
+void ProgressEstimator::addSample(double time, double iteration, double residual)
+{
+    if(!(residual > 0) || !std::isfinite(residual)) {
+        return;
+    }
+    samples.push_back({time, iteration, log(residual)});
+
+    // drop samples that are too old to be used again
+    double oldest = iteration * fitWindow;
+    unsigned int unused = 0;
+    while(unused < samples.size() && samples[unused].iteration < oldest && samples.size() - unused > minSamples) {
+        unused++;
+    }
+    samples.erase(samples.begin(), samples.begin() + unused);
+
+    update();
+}
+
+void ProgressEstimator::update()
+{
+    if(samples.size() < minSamples) {
+        return;
+    }
+
+    // least squares fit of the log residual over the iterations
+    double n = samples.size();
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for(auto &s : samples) {
+        sx += s.iteration;
+        sy += s.logResidual;
+        sxx += s.iteration * s.iteration;
+        sxy += s.iteration * s.logResidual;
+    }
+    double denom = n * sxx - sx * sx;
+    if(denom <= 0) {
+        return;
+    }
+    double slope = (n * sxy - sx * sy) / denom;
+    double offset = (sy - slope * sx) / n;
+    if(slope >= 0) {
+        // not converging (yet), keep the last estimate
+        return;
+    }
+    rate = exp(slope);
+
+    auto &last = samples.back();
+    double current = offset + slope * last.iteration;
+    remainingIterations = (logThreshold - current) / slope;
+    if(remainingIterations < 0) {
+        remainingIterations = 0;
+    }
+
+    auto &first = samples.front();
+    if(last.iteration > first.iteration) {
+        double timePerIteration = (last.time - first.time) / (last.iteration - first.iteration);
+        remainingTime = remainingIterations * timePerIteration;
+    }
+
+    double p = 100.0 * last.iteration / (last.iteration + remainingIterations);
+    if(p > percent) {
+        percent = p;
+    }
+}
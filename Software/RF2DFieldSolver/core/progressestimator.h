@@ -0,0 +1,47 @@
+#ifndef PROGRESSESTIMATOR_H
+#define PROGRESSESTIMATOR_H
+
+#include <vector>
+
+// Estimates the progress of an iterative solver from its residual history.
+// The logarithm of the residual is fitted with a straight line over the recent
+// samples (constant convergence rate) and extrapolated to the threshold. Only
+// uses the standard library, so recorded residual histories can be replayed
+// offline (see core/test).
+class ProgressEstimator
+{
+public:
+    ProgressEstimator();
+
+    void reset(double threshold);
+    // time in seconds since the start, iteration count and residual at that point
+    void addSample(double time, double iteration, double residual);
+
+    // progress in percent (0 to 100), never decreases
+    double getPercent() const {return percent;}
+    // estimated remaining time in seconds, negative if not known yet
+    double getRemainingTime() const {return remainingTime;}
+    // estimated number of iterations until the threshold is reached, negative if not known yet
+    double getRemainingIterations() const {return remainingIterations;}
+    // fitted residual reduction per iteration, 1.0 if not known yet
+    double getRate() const {return rate;}
+
+private:
+    void update();
+
+    class Sample {
+    public:
+        double time;
+        double iteration;
+        double logResidual;
+    };
+
+    std::vector<Sample> samples;
+    double logThreshold;
+    double percent;
+    double remainingTime;
+    double remainingIterations;
+    double rate;
+};
+
+#endif // PROGRESSESTIMATOR_H
@@ -0,0 +1,1622 @@
+#include "solver.h"
+
+#include "matrix.h"
+#include "polygon.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <sstream>
+
+namespace {
+
+// same format as QString::number
+std::string number(double value, int precision = 6)
+{
+    std::ostringstream s;
+    s << std::setprecision(precision) << value;
+    return s.str();
+}
+
+bool fuzzyCompare(double a, double b)
+{
+    return std::abs(a - b) * 1e12 <= std::min(std::abs(a), std::abs(b));
+}
+
+}
+
+Solver::Solver()
+{
+    listener = nullptr;
+    calculationRunning = false;
+    resultReady = false;
+    gridX = 1e-5;
+    gridY = 1e-5;
+    stepX = gridX;
+    stepY = gridY;
+    threads = 1;
+    threshold = 1e-6;
+    lattice = nullptr;
+    airLattice = nullptr;
+    airFieldAvailable = false;
+    fields = nullptr;
+    airFields = nullptr;
+    initialSolution = nullptr;
+    groundedBorders = true;
+    ignoreDielectric = false;
+    averaging = DielectricAveraging::Harmonic;
+    subCellBoundaries = true;
+    method = Method::Zebra;
+    acceleration = Acceleration::Chebyshev;
+    andersonWindow = 5;
+    chargeTolerance = 0;
+    timeBudget = 0;
+    chargeExtraction = ChargeExtraction::ConductorResidual;
+    matrixExtraction = false;
+    rasterized = nullptr;
+    excitationFailed = false;
+    excitationPhase = 0;
+    excitationPhases = 1;
+    chargeError = std::numeric_limits<double>::quiet_NaN();
+    budgetResultAvailable = false;
+    abortRequested = false;
+    lastProgressUpdate = 0;
+    progressIterations = 0;
+    thread = pthread_self();
+}
+
+Solver::~Solver()
+{
+    if(lattice) {
+        lattice_delete(lattice);
+    }
+    if(airLattice) {
+        lattice_delete(airLattice);
+    }
+    if(fields) {
+        fields_delete(fields);
+    }
+    if(airFields) {
+        fields_delete(airFields);
+    }
+}
+
+void Solver::setArea(const Point &topLeft, const Point &bottomRight)
+{
+    if(calculationRunning) {
+        return;
+    }
+    this->topLeft = topLeft;
+    this->bottomRight = bottomRight;
+}
+
+void Solver::setGrid(double gridX, double gridY)
+{
+    if(calculationRunning) {
+        return;
+    }
+    if(gridX > 0 && gridY > 0) {
+        this->gridX = gridX;
+        this->gridY = gridY;
+    }
+}
+
+void Solver::setThreads(int threads)
+{
+    if(calculationRunning) {
+        return;
+    }
+    if(threads > 0) {
+        this->threads = threads;
+    }
+}
+
+void Solver::setThreshold(double threshold)
+{
+    if(calculationRunning) {
+        return;
+    }
+    if (threshold > 0) {
+        this->threshold = threshold;
+    }
+}
+
+void Solver::setGroundedBorders(bool gnd)
+{
+    if(calculationRunning) {
+        return;
+    }
+    groundedBorders = gnd;
+}
+
+void Solver::setIgnoreDielectric(bool ignore)
+{
+    if(calculationRunning) {
+        return;
+    }
+    ignoreDielectric = ignore;
+}
+
+void Solver::setSubCellBoundaries(bool enabled)
+{
+    if(calculationRunning) {
+        return;
+    }
+    subCellBoundaries = enabled;
+}
+
+void Solver::setDielectricAveraging(DielectricAveraging averaging)
+{
+    if(calculationRunning) {
+        return;
+    }
+    if(averaging != DielectricAveraging::Last) {
+        this->averaging = averaging;
+    }
+}
+
+void Solver::setMethod(Method method)
+{
+    if(calculationRunning) {
+        return;
+    }
+    if(method != Method::Last) {
+        this->method = method;
+    }
+}
+
+void Solver::setAcceleration(Acceleration acceleration)
+{
+    if(calculationRunning) {
+        return;
+    }
+    if(acceleration != Acceleration::Last) {
+        this->acceleration = acceleration;
+    }
+}
+
+void Solver::setAndersonWindow(int window)
+{
+    if(calculationRunning) {
+        return;
+    }
+    if(window > 0 && window <= 255) {
+        andersonWindow = window;
+    }
+}
+
+void Solver::setChargeConvergence(double tolerance)
+{
+    if(calculationRunning) {
+        return;
+    }
+    if(tolerance >= 0) {
+        chargeTolerance = tolerance;
+    }
+}
+
+void Solver::setTimeBudget(double seconds)
+{
+    if(calculationRunning) {
+        return;
+    }
+    if(seconds >= 0) {
+        timeBudget = seconds;
+    }
+}
+
+void Solver::setChargeExtraction(ChargeExtraction extraction)
+{
+    if(calculationRunning) {
+        return;
+    }
+    if(extraction != ChargeExtraction::Last) {
+        chargeExtraction = extraction;
+    }
+}
+
+void Solver::setMatrixExtraction(bool enabled)
+{
+    if(calculationRunning) {
+        return;
+    }
+    matrixExtraction = enabled;
+}
+
+void Solver::setInitialSolution(Solver *solution)
+{
+    if(calculationRunning) {
+        return;
+    }
+    initialSolution = solution;
+}
+
+bool Solver::calculate(const Geometry &geometry)
+{
+    if(!prepareCalculation(geometry)) {
+        return false;
+    }
+    return runCalculation();
+}
+
+bool Solver::prepareCalculation(const Geometry &geometry)
+{
+    if(calculationRunning) {
+        return false;
+    }
+    calculationRunning = true;
+    resultReady = false;
+    progress.reset(threshold);
+    progressIterations = 0;
+    lastProgressUpdate = 0;
+    progressStart = std::chrono::steady_clock::now();
+    info("Laplace calculation starting");
+    if(lattice) {
+        lattice_delete(lattice);
+        lattice = nullptr;
+    }
+    if(airLattice) {
+        lattice_delete(airLattice);
+        airLattice = nullptr;
+    }
+    if(fields) {
+        fields_delete(fields);
+        fields = nullptr;
+    }
+    if(airFields) {
+        fields_delete(airFields);
+        airFields = nullptr;
+    }
+    airFieldAvailable = false;
+    // only valid for the calculation that extracted them
+    chargeMatrix.clear();
+    airChargeMatrix.clear();
+    abortRequested = false;
+    this->geometry = geometry;
+    return true;
+}
+
+bool Solver::runCalculation()
+{
+    if(!calculationRunning || resultReady) {
+        // not prepared
+        return false;
+    }
+    thread = pthread_self();
+    bool success = false;
+    if(abortRequested) {
+        // aborted before it was started
+    } else if(matrixExtraction) {
+        success = calcMatrix();
+    } else if(timeBudget > 0) {
+        success = calcWithinBudget();
+    } else {
+        success = calcSingle();
+    }
+    if(success && !lattice_compute_field(lattice, threads)) {
+        error("Failed to compute the electric field");
+        success = false;
+    }
+    calculationRunning = false;
+    if(!success) {
+        warning("Laplace calculation aborted");
+        resultReady = false;
+        percentage(0);
+    } else {
+        resultReady = true;
+        percentage(100);
+    }
+    return success;
+}
+
+void Solver::abortCalculation()
+{
+    if(!calculationRunning) {
+        return;
+    }
+    // request abort of calculation
+    std::lock_guard<std::mutex> locker(latticeMutex);
+    abortRequested = true;
+    if(lattice) {
+        lattice->abort = true;
+    }
+    for(auto &e : excitations) {
+        if(e.lattice) {
+            e.lattice->abort = true;
+        }
+    }
+}
+
+double Solver::getPotential(const Point &p)
+{
+    if(!resultReady) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    auto pos = coordToRect(p);
+    // convert to integers and shift by the added outside boundary of NaNs
+    int index_x = round(pos.x / lattice->step.x) + 1;
+    int index_y = round(pos.y / lattice->step.y) + 1;
+    if(index_x < 0 || index_x >= (int) lattice->dim.x || index_y < 0 || index_y >= (int) lattice->dim.y) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    auto c = &lattice->cells[index_x+index_y*lattice->dim.x];
+    return c->value;
+}
+
+double Solver::getFieldStrength(const Point &p)
+{
+    if(!resultReady || !lattice->field) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    auto pos = coordToRect(p);
+    // convert to integers and shift by the added outside boundary
+    int index_x = round(pos.x / lattice->step.x) + 1;
+    int index_y = round(pos.y / lattice->step.y) + 1;
+    if(index_x < 0 || index_x >= (int) lattice->dim.x || index_y < 0 || index_y >= (int) lattice->dim.y) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return lattice->field[3*(index_x+index_y*lattice->dim.x)+2];
+}
+
+double Solver::getMeanFieldStrength()
+{
+    if(!resultReady || !lattice->field) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return lattice->field_mean;
+}
+
+bool Solver::exportField(const std::string &filename)
+{
+    if(!resultReady || !lattice->field) {
+        return false;
+    }
+    std::ofstream file;
+    file.open(filename);
+    if(!file.is_open()) {
+        return false;
+    }
+    file << "x [m],y [m],potential [V],Ex [V/m],Ey [V/m],|E| [V/m]" << std::endl;
+    file << std::setprecision(9);
+    // only the cells inside the area, without the added outside rows and columns
+    for(unsigned int j=1;j<lattice->dim.y-1;j++) {
+        for(unsigned int i=1;i<lattice->dim.x-1;i++) {
+            auto index = i+j*lattice->dim.x;
+            auto c = &lattice->cells[index];
+            auto f = &lattice->field[3*index];
+            auto coord = coordFromRect(&c->pos);
+            file << coord.x << "," << coord.y << "," << c->value << "," << f[0] << "," << f[1] << "," << f[2] << std::endl;
+        }
+    }
+    file.close();
+    return true;
+}
+
+std::vector<Point> Solver::getGradients(const std::vector<Point> &points)
+{
+    auto nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<Point> ret;
+    ret.reserve(points.size());
+    if(!resultAvailable()) {
+        ret.assign(points.size(), Point(nan, nan));
+        return ret;
+    }
+    for(auto &p : points) {
+        auto pos = coordToRect(p);
+        // position in cells, shifted by the added outside boundary
+        double x = pos.x / lattice->step.x + 1;
+        double y = pos.y / lattice->step.y + 1;
+        int index_x = floor(x);
+        int index_y = floor(y);
+        if(index_x < 1 || index_x + 1 >= (int) lattice->dim.x - 1 || index_y < 1 || index_y + 1 >= (int) lattice->dim.y - 1) {
+            ret.push_back(Point(nan, nan));
+            continue;
+        }
+        double fx = x - index_x;
+        double fy = y - index_y;
+        auto g00 = cellGradient(index_x, index_y);
+        auto g10 = cellGradient(index_x + 1, index_y);
+        auto g01 = cellGradient(index_x, index_y + 1);
+        auto g11 = cellGradient(index_x + 1, index_y + 1);
+        ret.push_back((1-fy)*((1-fx)*g00+fx*g10)+fy*((1-fx)*g01+fx*g11));
+    }
+    return ret;
+}
+
+Point Solver::cellGradient(int index_x, int index_y)
+{
+    if(lattice->field) {
+        // the gradient points against the field
+        auto f = &lattice->field[3*(index_x+index_y*lattice->dim.x)];
+        return Point(-f[0], -f[1]);
+    }
+    auto cell = [=](int x, int y) -> struct cell* {
+        return &lattice->cells[x+y*lattice->dim.x];
+    };
+    // central differences, one sided next to the neumann borders
+    int left = index_x - 1, right = index_x + 1;
+    int bottom = index_y - 1, top = index_y + 1;
+    if(cell(left, index_y)->cond == NEUMANN) {
+        left = index_x;
+    }
+    if(cell(right, index_y)->cond == NEUMANN) {
+        right = index_x;
+    }
+    if(cell(index_x, bottom)->cond == NEUMANN) {
+        bottom = index_y;
+    }
+    if(cell(index_x, top)->cond == NEUMANN) {
+        top = index_y;
+    }
+    Point ret;
+    if(right > left) {
+        ret.x = (cell(right, index_y)->value - cell(left, index_y)->value) / ((right - left) * lattice->step.x);
+    }
+    if(top > bottom) {
+        ret.y = (cell(index_x, top)->value - cell(index_x, bottom)->value) / ((top - bottom) * lattice->step.y);
+    }
+    return ret;
+}
+
+bool Solver::resultAvailable()
+{
+    return resultReady || (calculationRunning && lattice && pthread_equal(pthread_self(), thread));
+}
+
+double Solver::getCharge(Shape::Type type)
+{
+    if(!resultAvailable()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    // every conductor number only once, even if it consists of several shapes
+    std::vector<int> conductors;
+    for(auto &s : geometry.getShapes()) {
+        if(s.type == type && std::find(conductors.begin(), conductors.end(), s.getConductor()) == conductors.end()) {
+            conductors.push_back(s.getConductor());
+        }
+    }
+    double charge = 0;
+    for(auto c : conductors) {
+        charge += lattice_charge(lattice, c, threads);
+    }
+    return charge;
+}
+
+double Solver::getCharge(int conductor)
+{
+    if(!resultReady) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return lattice_charge(lattice, conductor, threads);
+}
+
+double Solver::getContourCharge(int shape, double gridSize, bool dielectric)
+{
+    // distance of the innermost contour and between the contours, in grid steps
+    constexpr double firstDistance = 1.5;
+    constexpr double contourSpacing = 1.0;
+    constexpr unsigned int contours = 5;
+    // samples per grid step along the contours, the field is interpolated in between
+    constexpr double samplesPerStep = 2.0;
+
+    auto &shapes = geometry.getShapes();
+    if(shape < 0 || shape >= (int) shapes.size()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    auto &s = shapes[shape];
+
+    class Contour {
+    public:
+        std::vector<Point> vertices;
+        double charge;
+        // no other conductor touched or enclosed, completely inside the area
+        bool valid;
+        // at least one sample close to a change of the dielectric constant
+        bool crossesInterface;
+    };
+    std::vector<Contour> c;
+
+    // sample all contours at once
+    std::vector<Point> points;
+    std::vector<Point> tangents;
+    std::vector<double> lengths;
+    std::vector<int> contourIndex;
+    for(unsigned int i=0;i<contours;i++) {
+        // extend the shape polygon a bit
+        double distance = (firstDistance + i * contourSpacing) * gridSize;
+        Contour contour;
+        if(s.isLine()) {
+            // a line has no inside to offset, integrate around its bounding box instead
+            auto bounding = Polygon::bounds(s.vertices);
+            bounding.min += Point(-distance, -distance);
+            bounding.max += Point(distance, distance);
+            contour.vertices = {bounding.min, Point(bounding.max.x, bounding.min.y), bounding.max, Point(bounding.min.x, bounding.max.y)};
+        } else {
+            contour.vertices = Polygon::offset(s.vertices, distance);
+        }
+        contour.charge = 0;
+        contour.valid = true;
+        contour.crossesInterface = false;
+
+        auto &integral = contour.vertices;
+        for(unsigned int j=0;j<integral.size();j++) {
+            auto pp = integral[(j+integral.size()-1) % integral.size()];
+            auto pc = integral[j];
+
+            auto increment = pc - pp;
+            double length = sqrt(Point::dotProduct(increment, increment));
+            unsigned int samples = ceil(length * samplesPerStep / gridSize);
+            if(samples == 0) {
+                continue;
+            }
+            auto unitVector = increment * (1.0 / length);
+            double stepSize = length / samples;
+            auto step = unitVector * stepSize;
+            auto point = pp + step * 0.5;
+            for(unsigned int k=0;k<samples;k++) {
+                points.push_back(point);
+                tangents.push_back(unitVector);
+                lengths.push_back(stepSize);
+                contourIndex.push_back(i);
+                point += step;
+            }
+        }
+        c.push_back(contour);
+    }
+
+    // other conductors must neither be touched nor enclosed by a contour
+    for(unsigned int o=0;o<shapes.size();o++) {
+        auto &other = shapes[o];
+        if((int) o == shape || other.type == Shape::Type::Dielectric) {
+            continue;
+        }
+        for(auto &contour : c) {
+            for(auto &v : other.vertices) {
+                if(Polygon::contains(contour.vertices, v)) {
+                    contour.valid = false;
+                    break;
+                }
+            }
+        }
+        if(!other.isLine()) {
+            for(unsigned int i=0;i<points.size();i++) {
+                if(Polygon::contains(other.vertices, points[i])) {
+                    c[contourIndex[i]].valid = false;
+                }
+            }
+        }
+    }
+
+    auto gradients = getGradients(points);
+    for(unsigned int i=0;i<points.size();i++) {
+        auto &contour = c[contourIndex[i]];
+        auto gradient = gradients[i];
+        if(std::isnan(gradient.x) || std::isnan(gradient.y)) {
+            // outside of the simulation area
+            contour.valid = false;
+            continue;
+        }
+        if(dielectric) {
+            double er = geometry.getDielectricConstantAt(points[i]);
+            gradient *= er;
+            // compare with the dielectric constant one grid step to both sides of the contour
+            auto normal = Point(tangents[i].y, -tangents[i].x) * gridSize;
+            if(geometry.getDielectricConstantAt(points[i] + normal) != er || geometry.getDielectricConstantAt(points[i] - normal) != er) {
+                contour.crossesInterface = true;
+            }
+        }
+        // get amount of gradient that is perpendicular to our integration line
+        double perp = gradient.x * tangents[i].y - gradient.y * tangents[i].x;
+        contour.charge += perp * lengths[i];
+    }
+    for(auto &contour : c) {
+        if(!Polygon::isClockwise(contour.vertices)) {
+            contour.charge *= -1;
+        }
+    }
+
+    // prefer contours in uniform material, they are not affected by the field jump at the interfaces
+    std::vector<double> uniform, crossing;
+    for(auto &contour : c) {
+        if(!contour.valid) {
+            continue;
+        }
+        if(contour.crossesInterface) {
+            crossing.push_back(contour.charge);
+        } else {
+            uniform.push_back(contour.charge);
+        }
+    }
+    if(uniform.size() > 0) {
+        return std::accumulate(uniform.begin(), uniform.end(), 0.0) / uniform.size();
+    } else if(crossing.size() > 0) {
+        // the median is robust against single contours that are badly placed relative to the interface
+        std::sort(crossing.begin(), crossing.end());
+        auto n = crossing.size();
+        return n % 2 ? crossing[n/2] : (crossing[n/2-1] + crossing[n/2]) / 2;
+    } else {
+        // conductors too close to each other, use the innermost contour anyway
+        return c[0].charge;
+    }
+}
+
+std::vector<std::vector<double>> Solver::getCapacitanceMatrix()
+{
+    auto C = chargeMatrix;
+    for(auto &row : C) {
+        for(auto &v : row) {
+            v *= e0;
+        }
+    }
+    return C;
+}
+
+std::vector<std::vector<double>> Solver::getInductanceMatrix()
+{
+    // L = inverse(Cair) / c^2
+    auto L = Matrix::invert(airChargeMatrix);
+    for(auto &row : L) {
+        for(auto &v : row) {
+            v /= e0 * c0 * c0;
+        }
+    }
+    return L;
+}
+
+Solver::Modes Solver::getModes(int a, int b)
+{
+    auto nan = std::numeric_limits<double>::quiet_NaN();
+    Modes modes = {nan, nan, nan, nan};
+    if(!resultReady || a < 0 || b < 0 || a >= (int) chargeMatrix.size() || b >= (int) chargeMatrix.size() || a == b) {
+        return modes;
+    }
+    // both lines with all other conductors grounded
+    std::vector<std::vector<double>> C = {{chargeMatrix[a][a], chargeMatrix[a][b]}, {chargeMatrix[b][a], chargeMatrix[b][b]}};
+    auto L = Matrix::invert({{airChargeMatrix[a][a], airChargeMatrix[a][b]}, {airChargeMatrix[b][a], airChargeMatrix[b][b]}});
+    if(L.empty()) {
+        return modes;
+    }
+    for(auto &row : C) {
+        for(auto &v : row) {
+            v *= e0;
+        }
+    }
+    for(auto &row : L) {
+        for(auto &v : row) {
+            v /= e0 * c0 * c0;
+        }
+    }
+    // differential: +V/2 and -V/2 on the lines, the current flows in on one and back on the other line
+    double Cdiff = (C[0][0] - C[0][1] - C[1][0] + C[1][1]) / 4;
+    double Ldiff = L[0][0] - L[0][1] - L[1][0] + L[1][1];
+    // common: V on both lines, each carries half of the current
+    double Ccomm = C[0][0] + C[0][1] + C[1][0] + C[1][1];
+    double Lcomm = (L[0][0] + L[0][1] + L[1][0] + L[1][1]) / 4;
+    modes.differential = sqrt(Ldiff / Cdiff);
+    modes.common = sqrt(Lcomm / Ccomm);
+    modes.odd = modes.differential / 2;
+    modes.even = modes.common * 2;
+    return modes;
+}
+
+bool Solver::getTraceCharges(double &chargeP, double &chargeN, double &airChargeP, double &airChargeN)
+{
+    if(!resultReady || chargeMatrix.empty()) {
+        return false;
+    }
+    // superposition of the excitations with all traces at their potentials
+    chargeP = 0, chargeN = 0, airChargeP = 0, airChargeN = 0;
+    for(unsigned int i=0;i<conductors.size();i++) {
+        double q = 0, qAir = 0;
+        for(unsigned int j=0;j<conductors.size();j++) {
+            q += chargeMatrix[i][j] * conductorPotential(conductors[j]);
+            qAir += airChargeMatrix[i][j] * conductorPotential(conductors[j]);
+        }
+        if(conductorPotential(conductors[i]) > 0) {
+            chargeP += q;
+            airChargeP += qAir;
+        } else {
+            chargeN -= q;
+            airChargeN -= qAir;
+        }
+    }
+    return true;
+}
+
+Solver::Modes Solver::LineParameters::getModes() const
+{
+    if(!std::isnan(modes.differential)) {
+        // includes the coupling between the lines
+        return modes;
+    }
+    auto nan = std::numeric_limits<double>::quiet_NaN();
+    return {(impedanceP + impedanceN) / 2, nan, impedanceP + impedanceN, nan};
+}
+
+Solver::LineParameters Solver::getLineParameters(double airChargeP, double airChargeN)
+{
+    auto nan = std::numeric_limits<double>::quiet_NaN();
+    if(!resultReady) {
+        return {nan, nan, nan, nan, nan, nan, nan, {nan, nan, nan, nan}};
+    }
+    double chargeP, chargeN;
+    if(!chargeMatrix.empty()) {
+        getTraceCharges(chargeP, chargeN, airChargeP, airChargeN);
+        auto p = toLineParameters(chargeP, chargeN, airChargeP, airChargeN);
+        std::vector<int> pos, neg;
+        for(unsigned int i=0;i<conductors.size();i++) {
+            if(conductorPotential(conductors[i]) > 0) {
+                pos.push_back(i);
+            } else {
+                neg.push_back(i);
+            }
+        }
+        if(pos.size() == 1 && neg.size() == 1) {
+            // a single pair of coupled lines
+            p.modes = getModes(pos[0], neg[0]);
+            p.impedanceDiff = p.modes.differential;
+        }
+        return p;
+    } else if(chargeExtraction == ChargeExtraction::ConductorResidual) {
+        chargeP = getCharge(Shape::Type::TracePos);
+        chargeN = -getCharge(Shape::Type::TraceNeg);
+        if(ignoreDielectric || !geometry.hasDielectric()) {
+            // no dielectric, the field is the same
+            airChargeP = chargeP;
+            airChargeN = chargeN;
+        }
+    } else {
+        getContourCharges(false, airChargeP, airChargeN);
+        getContourCharges(!ignoreDielectric, chargeP, chargeN);
+    }
+    return toLineParameters(chargeP, chargeN, airChargeP, airChargeN);
+}
+
+Solver::LineParameters Solver::toLineParameters(double chargeP, double chargeN, double airChargeP, double airChargeN)
+{
+    auto nan = std::numeric_limits<double>::quiet_NaN();
+    LineParameters p = {nan, nan, nan, nan, nan, nan, nan, {nan, nan, nan, nan}};
+    p.capacitanceP = chargeP * e0;
+    p.capacitanceN = chargeN * e0;
+    p.inductanceP = 1.0 / (c0 * c0 * airChargeP * e0);
+    p.inductanceN = 1.0 / (c0 * c0 * airChargeN * e0);
+    p.impedanceP = sqrt(p.inductanceP / p.capacitanceP);
+    p.impedanceN = sqrt(p.inductanceN / p.capacitanceN);
+    p.impedanceDiff = p.impedanceP + p.impedanceN;
+    return p;
+}
+
+double Solver::getEnergy()
+{
+    if(!resultReady) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return lattice_energy(lattice, threads);
+}
+
+double Solver::getAirEnergy()
+{
+    if(!resultReady || !airFieldAvailable) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return lattice_energy(airLattice ? airLattice : lattice, threads);
+}
+
+bool Solver::getPerturbedEnergy(const Geometry &perturbed, double &energy, double &airEnergy)
+{
+    if(!resultReady || !airFieldAvailable || calculationRunning) {
+        return false;
+    }
+    // moved shapes would need the change of the fields at their boundaries, only the materials may differ
+    auto &shapes = perturbed.getShapes();
+    if(shapes.size() != geometry.getShapes().size()) {
+        return false;
+    }
+    for(unsigned int i=0;i<shapes.size();i++) {
+        auto &s = geometry.getShapes()[i];
+        if(shapes[i].type != s.type || shapes[i].conductor != s.conductor || shapes[i].line != s.line || shapes[i].vertices != s.vertices) {
+            return false;
+        }
+    }
+    // same area and grid, only the dielectric constants are exchanged
+    auto nominal = geometry;
+    bool ignore = ignoreDielectric;
+    geometry = perturbed;
+    auto l = createLattice(gridX, gridY);
+    if(l) {
+        lattice_interpolate(l, lattice);
+        energy = lattice_energy(l, threads);
+        lattice_delete(l);
+    }
+    ignoreDielectric = true;
+    auto a = l ? createLattice(gridX, gridY) : nullptr;
+    if(a) {
+        lattice_interpolate(a, airLattice ? airLattice : lattice);
+        airEnergy = lattice_energy(a, threads);
+        lattice_delete(a);
+    }
+    ignoreDielectric = ignore;
+    geometry = nominal;
+    return l && a;
+}
+
+void Solver::invalidateResult()
+{
+    resultReady = false;
+}
+
+void Solver::info(const std::string &info)
+{
+    if(listener) {
+        listener->info(info);
+    }
+}
+
+void Solver::warning(const std::string &warning)
+{
+    if(listener) {
+        listener->warning(warning);
+    }
+}
+
+void Solver::error(const std::string &error)
+{
+    if(listener) {
+        listener->error(error);
+    }
+}
+
+void Solver::percentage(int percent)
+{
+    if(listener) {
+        listener->percentage(percent);
+    }
+}
+
+void Solver::remainingTime(double seconds)
+{
+    if(listener) {
+        listener->remainingTime(seconds);
+    }
+}
+
+int64_t Solver::elapsed()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - progressStart).count();
+}
+
+Point Solver::coordFromRect(rect *pos)
+{
+    return Point(pos->x + topLeft.x, pos->y + bottomRight.y);
+}
+
+struct rect Solver::coordToRect(const Point &pos)
+{
+    struct rect ret;
+    ret.x = pos.x - topLeft.x;
+    ret.y = pos.y - bottomRight.y;
+    return ret;
+}
+
+bound *Solver::boundary(bound *bound, rect *pos)
+{
+    auto coord = coordFromRect(pos);
+    bound->value = 0;
+    bound->cond = NONE;
+
+    bool isBorder = fuzzyCompare(coord.x, topLeft.x) || fuzzyCompare(coord.x, bottomRight.x) || fuzzyCompare(coord.y, topLeft.y) || fuzzyCompare(coord.y, bottomRight.y);
+
+    // handle borders
+    if(groundedBorders && isBorder) {
+        bound->value = 0;
+        bound->cond = DIRICHLET;
+        return bound;
+    } else {
+        // find the matching polygon
+        for(auto &s : geometry.getShapes()) {
+            if(s.type == Shape::Type::Dielectric) {
+                // skip, dielectric has no influence on boundary and trace/GND should always take priority
+                continue;
+            }
+            if(s.isLine()) {
+                // conductor without thickness, only cells exactly on the line are part of it
+                auto &vertices = s.vertices;
+                for(unsigned int i=1;i<vertices.size();i++) {
+                    if(Polygon::distanceToLine(coord, vertices[i-1], vertices[i]) < std::min(gridX, gridY) * 1e-6) {
+                        bound->value = conductorValue(s.type);
+                        bound->cond = DIRICHLET;
+                        bound->conductor = s.getConductor();
+                        return bound;
+                    }
+                }
+                continue;
+            }
+            if(Polygon::contains(s.vertices, coord)) {
+                // this polygon defines the boundary at these coordinates
+                switch(s.type) {
+                case Shape::Type::GND:
+                    bound->value = 0;
+                    bound->cond = DIRICHLET;
+                    return bound;
+                case Shape::Type::TracePos:
+                    bound->value = 1.0;
+                    bound->cond = DIRICHLET;
+                    bound->conductor = s.getConductor();
+                    return bound;
+                case Shape::Type::TraceNeg:
+                    bound->value = -1.0;
+                    bound->cond = DIRICHLET;
+                    bound->conductor = s.getConductor();
+                    return bound;
+                case Shape::Type::Dielectric:
+                case Shape::Type::Last:
+                    return bound;
+                }
+            }
+        }
+    }
+    return bound;
+}
+
+double Solver::weight(rect *pos)
+{
+    if(ignoreDielectric) {
+        return 1.0;
+    }
+
+    auto coord = coordFromRect(pos);
+    if(averaging == DielectricAveraging::CellCenter) {
+        return sqrt(geometry.getDielectricConstantAt(coord));
+    }
+    // use the exact area fraction of every material within this cell
+    auto cell = Rect(coord - Point(stepX / 2, stepY / 2), coord + Point(stepX / 2, stepY / 2));
+    return geometry.getDielectricConstantIn(cell);
+}
+
+edge *Solver::edge(struct edge *edge, rect *from, rect *to)
+{
+    auto p1 = coordFromRect(from);
+    auto p2 = coordFromRect(to);
+    // The edge is prefilled with the adjacent cell. If that is a dirichlet cell on the border, the boundary is
+    // exactly at that cell. Conductors without thickness always cut the edge, conductors with thickness only
+    // if sub-cell boundaries are enabled (also catches conductors thinner than a cell between two free cells)
+    for(auto &s : geometry.getShapes()) {
+        if(s.type == Shape::Type::Dielectric) {
+            continue;
+        }
+        if(!s.isLine() && !subCellBoundaries) {
+            continue;
+        }
+        auto t = Polygon::firstIntersection(s.vertices, p1, p2, !s.isLine());
+        if(t >= 0 && t < edge->fraction) {
+            edge->fraction = t;
+            edge->value = conductorValue(s.type);
+            edge->cond = DIRICHLET;
+            edge->conductor = s.getConductor();
+        }
+    }
+    return edge;
+}
+
+double Solver::conductorPotential(int conductor)
+{
+    for(auto &s : geometry.getShapes()) {
+        if(s.getConductor() == conductor) {
+            return conductorValue(s.type);
+        }
+    }
+    return 0.0;
+}
+
+double Solver::conductorValue(Shape::Type type)
+{
+    switch(type) {
+    case Shape::Type::TracePos: return 1.0;
+    case Shape::Type::TraceNeg: return -1.0;
+    case Shape::Type::GND:
+    case Shape::Type::Dielectric:
+    case Shape::Type::Last:
+        return 0.0;
+    }
+    return 0.0;
+}
+
+struct lattice *Solver::createLattice(double gridX, double gridY)
+{
+    struct rect size = {bottomRight.x - topLeft.x, topLeft.y - bottomRight.y};
+    struct point dim = {(uint32_t) (size.x / gridX), (uint32_t) (size.y / gridY)};
+    if(dim.x > 0 && dim.y > 0) {
+        // the actual cell spacing, slightly larger than the grid if the area is not an integer multiple of it
+        stepX = size.x / dim.x;
+        stepY = size.y / dim.y;
+    }
+    enum averaging avg = AVERAGING_NONE;
+    switch(averaging) {
+    case DielectricAveraging::CellCenter:
+    case DielectricAveraging::Last:
+        avg = AVERAGING_NONE;
+        break;
+    case DielectricAveraging::Arithmetic:
+        avg = AVERAGING_ARITHMETIC;
+        break;
+    case DielectricAveraging::Harmonic:
+        avg = AVERAGING_HARMONIC;
+        break;
+    }
+    return lattice_new(&size, &dim, &boundaryTrampoline, &weightTrampoline, avg, &edgeTrampoline, this);
+}
+
+void Solver::setLattice(struct lattice *l)
+{
+    std::lock_guard<std::mutex> locker(latticeMutex);
+    lattice = l;
+    if(lattice && abortRequested) {
+        lattice->abort = true;
+    }
+}
+
+struct config Solver::createConfig()
+{
+    struct config conf = {(uint8_t) threads, 10, threshold, METHOD_GAUSS_SEIDEL, ACCELERATION_NONE, (uint8_t) andersonWindow, 0, 0, 0, nullptr, nullptr};
+    if(method == Method::Zebra) {
+        conf.method = METHOD_ZEBRA;
+        switch(acceleration) {
+        case Acceleration::Chebyshev:
+            conf.acceleration = ACCELERATION_CHEBYSHEV;
+            break;
+        case Acceleration::Anderson:
+            conf.acceleration = ACCELERATION_ANDERSON;
+            break;
+        case Acceleration::None:
+        case Acceleration::Last:
+            break;
+        }
+    } else if(acceleration != Acceleration::None) {
+        warning("Acceleration is only available for the zebra solver, ignoring it");
+    }
+    if(chargeTolerance > 0) {
+        if(conf.method == METHOD_GAUSS_SEIDEL) {
+            warning("Charge convergence is only available for the zebra solver, ignoring it");
+        } else {
+            // check the charge every 10 sweeps, it must be stable over the last 3 checks
+            conf.interval = 10;
+            conf.span = 3;
+            conf.tolerance = chargeTolerance;
+        }
+    }
+    return conf;
+}
+
+uint32_t Solver::compute(struct lattice *l, struct config conf, progress_callback_t cb, quantity_callback_t quantity, void *ptr, struct fields *f)
+{
+    // the potentials are within +/-1V, differences below this are only round-off
+    const double roundOff = 1e3 * std::numeric_limits<double>::epsilon();
+    // number of times a stagnated calculation is continued before its result is used anyway
+    constexpr int maxRestarts = 5;
+
+    if(conf.threads > l->dim.y / 5) {
+        conf.threads = std::max(1U, l->dim.y / 5);
+    }
+    conf.distance = l->dim.y / conf.threads;
+    conf.message = messageTrampoline;
+    conf.message_ptr = this;
+    info("Starting calculation threads");
+    auto run = [&]() -> uint32_t {
+        return f ? fields_compute(f, &conf, cb, quantity, ptr) : lattice_compute_threaded(l, &conf, cb, quantity, ptr);
+    };
+    auto it = run();
+
+    if(l->result == RESULT_DIVERGED && conf.acceleration != ACCELERATION_NONE && !abortRequested) {
+        // fall back to the plain relaxation, it always converges
+        warning("Calculation diverged after "+std::to_string(it)+" iterations, restarting without acceleration");
+        if(f) {
+            fields_reset(f);
+        } else {
+            lattice_reset(l);
+        }
+        conf.acceleration = ACCELERATION_NONE;
+        it += run();
+    }
+
+    // Stagnation above the round-off is slow convergence (e.g. a badly estimated acceleration), continue from the
+    // current potentials. The acceleration starts over with new parameters first, then it is not used anymore
+    for(int restarts = 0; l->result == RESULT_STAGNATED && l->reached > roundOff && restarts < maxRestarts; restarts++) {
+        {
+            std::lock_guard<std::mutex> locker(latticeMutex);
+            if(abortRequested) {
+                break;
+            }
+            l->abort = false;
+            l->result = RESULT_NONE;
+        }
+        std::string strategy = "continuing";
+        if(restarts > 0 && conf.acceleration != ACCELERATION_NONE) {
+            conf.acceleration = ACCELERATION_NONE;
+            strategy += " without acceleration";
+        }
+        info("Convergence stagnated at "+number(l->reached)+"V after "+std::to_string(it)+" iterations, "+strategy);
+        it += run();
+    }
+
+    switch(l->result) {
+    case RESULT_NONE:
+        break;
+    case RESULT_STAGNATED:
+        // the best possible result with this grid and scheme, use it
+        warning("Tolerance of "+number(threshold)+"V can not be reached, convergence stagnated at "
+                +number(l->reached)+"V after "+std::to_string(it)+" iterations. Using this result");
+        if(!abortRequested) {
+            l->abort = false;
+        }
+        break;
+    case RESULT_DIVERGED:
+        error("Calculation diverged after "+std::to_string(it)+" iterations");
+        break;
+    }
+    return it;
+}
+
+bool Solver::calcSingle()
+{
+    info("Creating lattice");
+    auto l = createLattice(gridX, gridY);
+    if(l) {
+        info("Lattice creation complete");
+    } else {
+        error("Lattice creation failed");
+        return false;
+    }
+    setLattice(l);
+
+    auto it = compute(lattice, createConfig(), calcProgressFromDiffTrampoline, quantityTrampoline, this);
+    if(lattice->abort) {
+        return false;
+    }
+    info("Laplace calculation complete, took "+std::to_string(it)+" iterations");
+    return true;
+}
+
+// calibrated cost model, shared by all calculations: cell updates per second and sweeps needed per grid line
+Solver::CostModel Solver::costModel = {0, 0, 0};
+std::mutex Solver::costModelMutex;
+
+bool Solver::calcWithinBudget()
+{
+    // grid refinement between two levels (in each direction)
+    const double refinement = sqrt(2.0);
+    // assumed convergence order of the charge for the error estimate (conservative)
+    constexpr double order = 1.0;
+    // the first level should only use a small part of the budget
+    constexpr double firstLevelShare = 0.05;
+    constexpr double minCells = 2000;
+
+    double area = (bottomRight.x - topLeft.x) * (topLeft.y - bottomRight.y);
+    auto predictTime = [](double cells) -> double {
+        std::lock_guard<std::mutex> locker(costModelMutex);
+        return cells * sqrt(cells) * costModel.sweepsPerLine / costModel.throughput;
+    };
+    bool calibrated;
+    {
+        std::lock_guard<std::mutex> locker(costModelMutex);
+        calibrated = costModel.levels > 0 && costModel.throughput > 0 && costModel.sweepsPerLine > 0;
+    }
+
+    // start with a coarse grid that fits into a small part of the budget
+    double cells = minCells;
+    if(calibrated) {
+        while(predictTime(cells * refinement * refinement) < timeBudget * firstLevelShare) {
+            cells *= refinement * refinement;
+        }
+    }
+
+    info("Solving within "+number(timeBudget)+"s");
+    auto levelConfig = createConfig();
+    struct lattice *best = nullptr;
+    double lastCharge = std::numeric_limits<double>::quiet_NaN();
+    chargeError = std::numeric_limits<double>::quiet_NaN();
+    budgetResultAvailable = false;
+    while(true) {
+        // same aspect ratio as the requested grid, but never finer
+        double scale = std::max(1.0, sqrt(area / (cells * gridX * gridY)));
+        auto l = createLattice(gridX * scale, gridY * scale);
+        if(!l) {
+            error("Lattice creation failed");
+            break;
+        }
+        if(best) {
+            lattice_interpolate(l, best);
+        }
+        setLattice(l);
+
+        // the method is the configured one, the budget only decides when a level is accurate enough: a bit more
+        // accurate than the discretization error of the last level (the charge is only watched by the zebra solver)
+        auto conf = levelConfig;
+        if(conf.method == METHOD_ZEBRA) {
+            conf.interval = 10;
+            conf.span = 3;
+            conf.tolerance = std::isnan(chargeError) ? 1e-4 : std::max(1e-6, chargeError / 10);
+        }
+        auto levelStart = std::chrono::steady_clock::now();
+        auto it = compute(l, conf, calcProgressFromDiffTrampoline, quantityTrampoline, this);
+        double seconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - levelStart).count() / 1000.0;
+
+        if(l->abort) {
+            // either aborted by the user or the budget is used up, continue with the last level
+            setLattice(best);
+            lattice_delete(l);
+            if(abortRequested || !best) {
+                return false;
+            }
+            break;
+        }
+
+        // calibrate the cost model, both values are updated together
+        double n = sqrt((double) l->dim.x * l->dim.y);
+        if(seconds > 0) {
+            std::lock_guard<std::mutex> locker(costModelMutex);
+            double weight = 1.0 / ++costModel.levels;
+            costModel.throughput += ((double) l->dim.x * l->dim.y * it / seconds - costModel.throughput) * weight;
+            costModel.sweepsPerLine += (it / n - costModel.sweepsPerLine) * weight;
+        }
+
+        double charge = quantity();
+        if(!std::isnan(lastCharge) && charge != 0) {
+            chargeError = std::abs(charge - lastCharge) / std::abs(charge) / (pow(refinement, order) - 1);
+        }
+        lastCharge = charge;
+        if(best) {
+            lattice_delete(best);
+        }
+        best = l;
+        budgetResultAvailable = true;
+        info("Level with "+std::to_string(l->dim.x)+"x"+std::to_string(l->dim.y)+" cells done after "+std::to_string(it)
+             +" iterations, estimated error: "+(std::isnan(chargeError) ? std::string("unknown") : number(chargeError * 100, 2)+"%"));
+
+        if(scale <= 1.0) {
+            // reached the requested resolution
+            break;
+        }
+        cells *= refinement * refinement;
+        double remaining = timeBudget - elapsed() / 1000.0;
+        if(predictTime(cells) > remaining) {
+            break;
+        }
+    }
+    return best != nullptr;
+}
+
+bool Solver::calcMatrix()
+{
+    conductors = geometry.getConductors();
+    if(conductors.empty()) {
+        error("No traces, the conductor matrix can not be extracted");
+        return false;
+    }
+    if(timeBudget > 0) {
+        warning("The time budget is not available for the conductor matrix, ignoring it");
+    }
+    bool dielectric = !ignoreDielectric && geometry.hasDielectric();
+    excitationPhases = dielectric ? 2 : 1;
+    excitationPhase = 0;
+    if(dielectric) {
+        // the inductance matrix only depends on the geometry, solve without the dielectric first
+        ignoreDielectric = true;
+        bool success = solveExcitations(airChargeMatrix, &airLattice, &airFields);
+        ignoreDielectric = false;
+        if(!success) {
+            return false;
+        }
+        excitationPhase++;
+    }
+    struct lattice *l = nullptr;
+    if(!solveExcitations(chargeMatrix, &l, &fields)) {
+        return false;
+    }
+    setLattice(l);
+    if(!dielectric) {
+        airChargeMatrix = chargeMatrix;
+    }
+    airFieldAvailable = true;
+    return true;
+}
+
+bool Solver::solveExcitations(std::vector<std::vector<double>> &charges, struct lattice **result, struct fields **excitationFields)
+{
+    info("Creating lattice");
+    rasterized = createLattice(gridX, gridY);
+    if(rasterized) {
+        info("Lattice creation complete");
+    } else {
+        error("Lattice creation failed");
+        return false;
+    }
+
+    // the superposition with all traces at their potentials is kept (same field as without the matrix)
+    std::vector<double> weights;
+    for(auto c : conductors) {
+        weights.push_back(conductorPotential(c));
+    }
+
+    if(method == Method::Zebra) {
+        bool success = solveInterleaved(charges, weights.data(), excitationFields);
+        if(success) {
+            *result = rasterized;
+        } else {
+            lattice_delete(rasterized);
+        }
+        rasterized = nullptr;
+        return success;
+    }
+
+    // all excitations share the rasterized geometry, every worker solves one copy at a time
+    int count = conductors.size();
+    {
+        std::lock_guard<std::mutex> locker(latticeMutex);
+        excitations.clear();
+        for(auto c : conductors) {
+            excitations.push_back({this, nullptr, c, 0, 0});
+        }
+    }
+    excitationCharges.assign(count, std::vector<double>(count, 0));
+    excitationConfig = createConfig();
+    int workers = std::min(count, threads);
+    excitationConfig.threads = std::max(1, threads / workers);
+    nextExcitation = 0;
+    excitationFailed = false;
+    info("Solving "+std::to_string(count)+" excitations, "+std::to_string(workers)+" at a time");
+
+    // the calculation thread is the first worker
+    std::vector<pthread_t> ids(workers - 1);
+    int started = 0;
+    for(auto &id : ids) {
+        if(pthread_create(&id, nullptr, excitationWorkerTrampoline, this)) {
+            warning("Failed to start excitation thread");
+            break;
+        }
+        started++;
+    }
+    excitationWorker();
+    for(int i=0;i<started;i++) {
+        pthread_join(ids[i], nullptr);
+    }
+
+    lattice_delete(rasterized);
+    rasterized = nullptr;
+    std::vector<struct lattice*> solved;
+    {
+        std::lock_guard<std::mutex> locker(latticeMutex);
+        for(auto &e : excitations) {
+            solved.push_back(e.lattice);
+        }
+        excitations.clear();
+    }
+    bool success = !excitationFailed;
+    if(success) {
+        charges = excitationCharges;
+        // superposition into the lattice of the first excitation
+        auto l = solved[0];
+        uint32_t m = l->dim.x * l->dim.y + l->ghosts;
+        for(uint32_t index=0;index<m;index++) {
+            if(l->cells[index].cond != DIRICHLET && !l->update[index]) {
+                continue;
+            }
+            double value = 0;
+            for(unsigned int k=0;k<solved.size();k++) {
+                value += weights[k] * solved[k]->cells[index].value;
+            }
+            l->cells[index].value = value;
+        }
+        *result = l;
+    }
+    for(unsigned int k=0;k<solved.size();k++) {
+        if(solved[k] && (!success || k > 0)) {
+            lattice_delete(solved[k]);
+        }
+    }
+    return success;
+}
+
+bool Solver::solveInterleaved(std::vector<std::vector<double>> &charges, const double *weights, struct fields **excitationFields)
+{
+    // all excitations are relaxed in the same sweep, they share the coefficients and adjacent cells
+    int count = conductors.size();
+    int stride = *std::max_element(conductors.begin(), conductors.end()) + 1;
+    std::vector<double> potentials(count * stride, 0);
+    for(int i=0;i<count;i++) {
+        potentials[i * stride + conductors[i]] = 1.0;
+    }
+    auto f = fields_new(rasterized, potentials.data(), stride, count);
+    if(!f) {
+        error("Lattice creation failed");
+        return false;
+    }
+    if(initialSolution && initialSolution->conductors == conductors) {
+        // start from the same excitations of the other solution (without dielectric if it has that one separately)
+        auto from = ignoreDielectric && initialSolution->airFields ? initialSolution->airFields : initialSolution->fields;
+        if(from) {
+            fields_interpolate(f, from);
+        }
+    }
+    auto conf = createConfig();
+    if(conf.acceleration == ACCELERATION_ANDERSON) {
+        warning("Anderson mixing is not available for the conductor matrix, using the chebyshev acceleration");
+    }
+    if(conf.interval > 0) {
+        warning("Charge convergence is not available for the conductor matrix, ignoring it");
+    }
+    {
+        std::lock_guard<std::mutex> locker(latticeMutex);
+        excitations.clear();
+        excitations.push_back({this, rasterized, 0, 0, 0});
+        if(abortRequested) {
+            rasterized->abort = true;
+        }
+    }
+    info("Solving "+std::to_string(count)+" excitations in one sweep");
+
+    auto it = compute(rasterized, conf, excitationProgressTrampoline, nullptr, &excitations[0], f);
+    bool success = !rasterized->abort;
+    if(success) {
+        charges.assign(count, std::vector<double>(count, 0));
+        for(int i=0;i<count;i++) {
+            fields_load(f, i);
+            for(int j=0;j<count;j++) {
+                charges[j][i] = lattice_charge(rasterized, conductors[j], threads);
+            }
+        }
+        fields_combine(f, weights);
+        info("Excitations complete, took "+std::to_string(it)+" iterations");
+    }
+    {
+        std::lock_guard<std::mutex> locker(latticeMutex);
+        excitations.clear();
+    }
+    if(success) {
+        *excitationFields = f;
+    } else {
+        fields_delete(f);
+    }
+    return success;
+}
+
+void* Solver::excitationWorker()
+{
+    // potentials indexed by the conductor number
+    std::vector<double> potentials(*std::max_element(conductors.begin(), conductors.end()) + 1, 0);
+    while(!excitationFailed) {
+        int i = nextExcitation++;
+        if(i >= (int) excitations.size()) {
+            break;
+        }
+        auto &e = excitations[i];
+        auto l = lattice_copy(rasterized);
+        if(!l) {
+            error("Lattice creation failed");
+            excitationFailed = true;
+            break;
+        }
+        potentials[e.conductor] = 1.0;
+        lattice_excite(l, potentials.data(), potentials.size());
+        potentials[e.conductor] = 0.0;
+        {
+            std::lock_guard<std::mutex> locker(latticeMutex);
+            e.lattice = l;
+            if(abortRequested) {
+                l->abort = true;
+            }
+        }
+
+        auto it = compute(l, excitationConfig, excitationProgressTrampoline, excitationQuantityTrampoline, &e);
+        if(l->abort) {
+            excitationFailed = true;
+            break;
+        }
+        for(unsigned int j=0;j<conductors.size();j++) {
+            excitationCharges[j][i] = lattice_charge(l, conductors[j], excitationConfig.threads);
+        }
+        info("Excitation of conductor "+std::to_string(e.conductor)+" complete, took "+std::to_string(it)+" iterations");
+        {
+            std::lock_guard<std::mutex> locker(progressMutex);
+            e.progress = 1.0;
+        }
+    }
+    if(excitationFailed) {
+        // stop the other workers as well
+        std::lock_guard<std::mutex> locker(latticeMutex);
+        for(auto &e : excitations) {
+            if(e.lattice) {
+                e.lattice->abort = true;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void Solver::excitationProgress(Excitation *e, double diff)
+{
+    // minimum time between two progress updates
+    constexpr int64_t updateInterval = 100;
+
+    std::lock_guard<std::mutex> locker(progressMutex);
+    // the progress of one excitation is the logarithmic distance from its first difference to the threshold
+    if(e->firstDiff == 0) {
+        e->firstDiff = diff;
+    }
+    if(diff > 0 && e->firstDiff > threshold) {
+        e->progress = std::clamp(log(e->firstDiff / diff) / log(e->firstDiff / threshold), 0.0, 1.0);
+    }
+    auto elapsed = this->elapsed();
+    if(elapsed - lastProgressUpdate < updateInterval) {
+        return;
+    }
+    lastProgressUpdate = elapsed;
+    double sum = 0;
+    for(auto &x : excitations) {
+        sum += x.progress;
+    }
+    double fraction = (excitationPhase + sum / excitations.size()) / excitationPhases;
+    percentage(fraction * 100);
+    remainingTime(fraction > 0.01 ? elapsed / 1000.0 * (1.0 - fraction) / fraction : -1.0);
+}
+
+double Solver::quantity()
+{
+    // the total charge on the traces, proportional to the capacitance
+    if(chargeExtraction == ChargeExtraction::ConductorResidual) {
+        return getCharge(Shape::Type::TracePos) - getCharge(Shape::Type::TraceNeg);
+    }
+    double chargeP, chargeN;
+    getContourCharges(!ignoreDielectric, chargeP, chargeN);
+    return chargeP + chargeN;
+}
+
+void Solver::getContourCharges(bool dielectric, double &chargeP, double &chargeN)
+{
+    // sample the integration path at least as fine as the grid in both directions
+    chargeP = 0, chargeN = 0;
+    auto &shapes = geometry.getShapes();
+    for(unsigned int i=0;i<shapes.size();i++) {
+        switch(shapes[i].type) {
+        case Shape::Type::TracePos:
+            chargeP += getContourCharge(i, std::min(stepX, stepY), dielectric);
+            break;
+        case Shape::Type::TraceNeg:
+            chargeN -= getContourCharge(i, std::min(stepX, stepY), dielectric);
+            break;
+        case Shape::Type::GND:
+        case Shape::Type::Dielectric:
+        case Shape::Type::Last:
+            break;
+        }
+    }
+}
+
+void Solver::calcProgressFromDiff(double diff)
+{
+    // minimum time between two progress updates
+    constexpr int64_t updateInterval = 100;
+
+    std::lock_guard<std::mutex> locker(progressMutex);
+    progressIterations++;
+    auto elapsed = this->elapsed();
+    if(elapsed - lastProgressUpdate < updateInterval) {
+        return;
+    }
+    lastProgressUpdate = elapsed;
+    if(timeBudget > 0) {
+        // the budget defines the progress, stop a level that would exceed it
+        double seconds = elapsed / 1000.0;
+        if(seconds > timeBudget && budgetResultAvailable) {
+            lattice->abort = true;
+        }
+        percentage(std::min(100.0, seconds * 100 / timeBudget));
+        remainingTime(std::max(0.0, timeBudget - seconds));
+        return;
+    }
+    progress.addSample(elapsed / 1000.0, progressIterations, diff);
+    percentage(progress.getPercent());
+    remainingTime(progress.getRemainingTime());
+}
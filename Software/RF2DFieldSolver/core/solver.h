@@ -0,0 +1,311 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <pthread.h>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "geometry.h"
+#include "lattice.h"
+#include "fields.h"
+#include "progressestimator.h"
+
+// Laplace solver for the potential of a cross section and the charges on its conductors. Only uses the
+// standard library and pthreads, so it can be embedded without Qt. The calculation runs in the calling
+// thread, it can be aborted from any other thread. Messages and progress are reported to the listener
+class Solver
+{
+public:
+    Solver();
+    ~Solver();
+
+    // vacuum permittivity (F/m) and speed of light (m/s)
+    static constexpr double e0 = 8.8541878188e-12;
+    static constexpr double c0 = 2.998e8;
+
+    // receives the messages and the progress of a calculation, called from all calculation threads
+    class Listener {
+    public:
+        virtual ~Listener() {}
+        virtual void info(const std::string &info) {(void) info;}
+        virtual void warning(const std::string &warning) {(void) warning;}
+        virtual void error(const std::string &error) {(void) error;}
+        virtual void percentage(int percent) {(void) percent;}
+        // estimated remaining calculation time in seconds, negative if not known yet
+        virtual void remainingTime(double seconds) {(void) seconds;}
+    };
+
+    enum class DielectricAveraging {
+        // dielectric constant sampled at the cell center (legacy behavior)
+        CellCenter,
+        // area weighted dielectric constant per cell, arithmetic mean on the stencil edges
+        Arithmetic,
+        // area weighted dielectric constant per cell, harmonic mean on the stencil edges
+        Harmonic,
+        Last,
+    };
+
+    enum class Method {
+        // pipelined point gauss-seidel (legacy behavior)
+        GaussSeidel,
+        // zebra line relaxation, rows solved with the thomas algorithm
+        Zebra,
+        Last,
+    };
+
+    enum class Acceleration {
+        None,
+        // chebyshev semi-iteration on symmetric zebra sweeps
+        Chebyshev,
+        // anderson mixing of the last iterates every few zebra sweeps
+        Anderson,
+        Last,
+    };
+
+    enum class ChargeExtraction {
+        // integration of the field along a contour around the conductor
+        GaussContour,
+        // flux from the conductor cells into the adjacent free cells (stencil residual)
+        ConductorResidual,
+        Last,
+    };
+
+    // the listener must stay valid while calculating, nullptr discards all messages
+    void setListener(Listener *listener) {this->listener = listener;}
+    void setArea(const Point &topLeft, const Point &bottomRight);
+    void setGrid(double gridX, double gridY);
+    void setThreads(int threads);
+    void setThreshold(double threshold);
+    void setGroundedBorders(bool gnd);
+    void setIgnoreDielectric(bool ignore);
+    void setDielectricAveraging(DielectricAveraging averaging);
+    void setSubCellBoundaries(bool enabled);
+    void setMethod(Method method);
+    void setAcceleration(Acceleration acceleration);
+    void setAndersonWindow(int window);
+    // stop as soon as the charge on the traces changes by less than the relative tolerance (0 disables it)
+    void setChargeConvergence(double tolerance);
+    // solve on progressively finer grids (up to the configured one) until the time runs out, 0 disables it
+    void setTimeBudget(double seconds);
+    // how the charge for the charge convergence and the time budget is determined
+    void setChargeExtraction(ChargeExtraction extraction);
+    // solve one excitation per conductor (1V on it, all others grounded) and extract the charge matrices
+    void setMatrixExtraction(bool enabled);
+    // the next conductor matrix calculation starts from the fields of an other one with the same conductors
+    // (e.g. a neighbouring point of a sweep) instead of zero. It must not be recalculated while this one runs
+    void setInitialSolution(Solver *solution);
+
+    // prepares and runs a calculation of the geometry (a copy is kept for the evaluation of the result)
+    bool calculate(const Geometry &geometry);
+    // same in two steps, e.g. to run the calculation in a different thread. False if a calculation is already running
+    bool prepareCalculation(const Geometry &geometry);
+    bool runCalculation();
+    void abortCalculation();
+    bool isCalculationRunning() {return calculationRunning;}
+
+    double getPotential(const Point &p);
+    // gradients (V/m) at all points, bilinearly interpolated between central differences at the cells, NaN outside of the area
+    std::vector<Point> getGradients(const std::vector<Point> &points);
+    // magnitude of the electric field (V/m) at the closest cell and its mean over the area, NaN if there is no result
+    double getFieldStrength(const Point &p);
+    double getMeanFieldStrength();
+    // writes the potential and the electric field of all cells as CSV
+    bool exportField(const std::string &filename);
+    bool isResultReady() {return resultReady;}
+    // relative error of the trace charge estimated from the last two grids of a time budgeted calculation, NaN if not known
+    double getErrorEstimate() {return chargeError;}
+    // charge (divided by e0, per meter) of all conductors of this type, from the stencil residuals
+    double getCharge(Shape::Type type);
+    // charge (divided by e0, per meter) of one conductor, from the stencil residuals
+    double getCharge(int conductor);
+    // charge (divided by e0, per meter) of a shape of the calculated geometry, from a gauss contour around it. Contours
+    // that touch or enclose other conductors are excluded, the dielectric constants are included if enabled
+    double getContourCharge(int shape, double gridSize, bool dielectric);
+    // numbers of the conductors in the order of the matrix rows and columns
+    std::vector<int> getConductors() {return conductors;}
+    // charge (divided by e0, per meter) on conductor i with 1V on conductor j, with and without dielectric
+    std::vector<std::vector<double>> getChargeMatrix() {return chargeMatrix;}
+    std::vector<std::vector<double>> getAirChargeMatrix() {return airChargeMatrix;}
+    // capacitance matrix (F/m) and inductance matrix (H/m, inverse of the air capacitance matrix), empty if there is
+    // no matrix or the air matrix is singular
+    std::vector<std::vector<double>> getCapacitanceMatrix();
+    std::vector<std::vector<double>> getInductanceMatrix();
+    // impedances (ohm) of two coupled lines, a and b are indexes into the conductors, NaN if there is no matrix
+    class Modes {
+    public:
+        double odd, even, differential, common;
+    };
+    Modes getModes(int a, int b);
+    // charges (divided by e0, per meter) of the traces at their potentials (+1V/-1V), from the conductor matrices
+    bool getTraceCharges(double &chargeP, double &chargeN, double &airChargeP, double &airChargeN);
+    // capacitance (F/m), inductance (H/m) and impedance (ohm) of the traces. The modes are only available from the
+    // conductor matrices of a single pair of coupled lines, otherwise the differential impedance is the sum of both
+    class LineParameters {
+    public:
+        double capacitanceP, capacitanceN;
+        double inductanceP, inductanceN;
+        double impedanceP, impedanceN, impedanceDiff;
+        Modes modes;
+        // the modes if available. Otherwise the +1V/-1V excitation is the odd mode and the even mode is not known
+        Modes getModes() const;
+    };
+    // from the conductor matrices if they were extracted, otherwise from the charges of the selected extraction. The
+    // residual charges of a calculation with dielectric need the trace charges of a separate calculation without it
+    // for the inductance, they are ignored in the other cases
+    LineParameters getLineParameters(double airChargeP = std::numeric_limits<double>::quiet_NaN(),
+                                     double airChargeN = std::numeric_limits<double>::quiet_NaN());
+    // energy (divided by e0, per meter) stored in the field. Twice the energy is the sum of charge times potential,
+    // but only approximately (within a few percent) with sub-cell boundaries, their stencil is not symmetric
+    double getEnergy();
+    // same for the field without dielectric, only available after a conductor matrix calculation
+    double getAirEnergy();
+    // Energy of the fields with and without dielectric on the lattice of a geometry with changed dielectric constants.
+    // The converged fields minimize the energy for the given conductor potentials, so the change of the fields only
+    // changes it in second order and this is the energy of the changed problem to first order without solving it.
+    // That does not hold if the shapes move (the boundaries of the fields change), false if the perturbed geometry
+    // differs in anything but the dielectric constants. Only available after a conductor matrix calculation
+    bool getPerturbedEnergy(const Geometry &perturbed, double &energy, double &airEnergy);
+    void invalidateResult();
+
+private:
+    void info(const std::string &info);
+    void warning(const std::string &warning);
+    void error(const std::string &error);
+    void percentage(int percent);
+    void remainingTime(double seconds);
+    // milliseconds since the start of the calculation
+    int64_t elapsed();
+    Point coordFromRect(struct rect *pos);
+    struct rect coordToRect(const Point &pos);
+    Point cellGradient(int index_x, int index_y);
+    // intermediate results may only be used from the calculation thread itself
+    bool resultAvailable();
+    bound* boundary(struct bound* bound, struct rect* pos);
+    static struct bound* boundaryTrampoline(void *ptr, struct bound* bound, struct rect* pos) {
+        return ((Solver*)ptr)->boundary(bound, pos);
+    }
+    double weight(struct rect *pos);
+    static double weightTrampoline(void *ptr, struct rect* pos) {
+        return ((Solver*)ptr)->weight(pos);
+    }
+    struct edge* edge(struct edge* edge, struct rect* from, struct rect* to);
+    static struct edge* edgeTrampoline(void *ptr, struct edge* edge, struct rect* from, struct rect* to) {
+        return ((Solver*)ptr)->edge(edge, from, to);
+    }
+    static double conductorValue(Shape::Type type);
+    double conductorPotential(int conductor);
+    struct lattice *createLattice(double gridX, double gridY);
+    void setLattice(struct lattice *l);
+    struct config createConfig();
+    // computes the values of the lattice, or all fields if given
+    uint32_t compute(struct lattice *l, struct config conf, progress_callback_t cb, quantity_callback_t quantity, void *ptr, struct fields *f = nullptr);
+    bool calcSingle();
+    bool calcWithinBudget();
+    bool calcMatrix();
+    // solves one excitation per conductor, the result is the superposition with all traces at their potentials
+    // the fields of the single excitations are returned as well if they were solved together
+    bool solveExcitations(std::vector<std::vector<double>> &charges, struct lattice **result, struct fields **excitationFields);
+    bool solveInterleaved(std::vector<std::vector<double>> &charges, const double *weights, struct fields **excitationFields);
+    // one excitation of the matrix extraction, solved on its own copy of the lattice
+    class Excitation {
+    public:
+        Solver *solver;
+        struct lattice *lattice;
+        int conductor;
+        double firstDiff;
+        double progress;
+    };
+    void* excitationWorker();
+    static void* excitationWorkerTrampoline(void *ptr) {
+        return ((Solver*)ptr)->excitationWorker();
+    }
+    void excitationProgress(Excitation *e, double diff);
+    static void excitationProgressTrampoline(void *ptr, double diff) {
+        ((Excitation*)ptr)->solver->excitationProgress((Excitation*)ptr, diff);
+    }
+    static double excitationQuantityTrampoline(void *ptr) {
+        return lattice_charge(((Excitation*)ptr)->lattice, ((Excitation*)ptr)->conductor, 1);
+    }
+    double quantity();
+    // sum of the contour charges of the positive traces and negated sum of the negative traces
+    void getContourCharges(bool dielectric, double &chargeP, double &chargeN);
+    LineParameters toLineParameters(double chargeP, double chargeN, double airChargeP, double airChargeN);
+    static double quantityTrampoline(void *ptr) {
+        return ((Solver*)ptr)->quantity();
+    }
+    static void messageTrampoline(void *ptr, const char *message) {
+        ((Solver*)ptr)->info(message);
+    }
+    void calcProgressFromDiff(double diff);
+    static void calcProgressFromDiffTrampoline(void *ptr, double diff) {
+        ((Solver*)ptr)->calcProgressFromDiff(diff);
+    }
+    Listener *listener;
+    std::atomic<bool> calculationRunning;
+    std::atomic<bool> resultReady;
+    Geometry geometry;
+    Point topLeft, bottomRight;
+    double gridX, gridY;
+    double stepX, stepY;
+    int threads;
+    double threshold;
+    bool groundedBorders;
+    bool ignoreDielectric;
+    DielectricAveraging averaging;
+    bool subCellBoundaries;
+    Method method;
+    Acceleration acceleration;
+    int andersonWindow;
+    double chargeTolerance;
+    double timeBudget;
+    ChargeExtraction chargeExtraction;
+    bool matrixExtraction;
+    std::vector<int> conductors;
+    std::vector<std::vector<double>> chargeMatrix, airChargeMatrix;
+    // state shared by the workers of the matrix extraction
+    struct lattice *rasterized;
+    struct config excitationConfig;
+    std::vector<Excitation> excitations;
+    std::vector<std::vector<double>> excitationCharges;
+    std::atomic<int> nextExcitation;
+    std::atomic<bool> excitationFailed;
+    int excitationPhase, excitationPhases;
+    double chargeError;
+    bool budgetResultAvailable;
+    // cost model of the time budget, averaged over all solved levels
+    class CostModel {
+    public:
+        // cells times sweeps per second
+        double throughput;
+        // sweeps per cell along one axis
+        double sweepsPerLine;
+        unsigned int levels;
+    };
+    // shared by all solvers, several of them may calculate at the same time (e.g. the workers of a sweep)
+    static CostModel costModel;
+    static std::mutex costModelMutex;
+    struct lattice *lattice;
+    // superposition of the excitations without dielectric (conductor matrix only)
+    struct lattice *airLattice;
+    bool airFieldAvailable;
+    // the excitations of the conductor matrix with and without dielectric (zebra solver only)
+    struct fields *fields, *airFields;
+    Solver *initialSolution;
+    std::mutex latticeMutex;
+    bool abortRequested;
+    // progress updates come from all threads, only evaluated every few milliseconds
+    ProgressEstimator progress;
+    std::mutex progressMutex;
+    std::chrono::steady_clock::time_point progressStart;
+    int64_t lastProgressUpdate;
+    unsigned long progressIterations;
+
+    // the thread that runs the calculation
+    pthread_t thread;
+};
+
+#endif // SOLVER_H
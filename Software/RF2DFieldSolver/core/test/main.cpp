@@ -0,0 +1,164 @@
+// Smoke test of the solver core: a parallel plate capacitor with a uniform field, its capacitance is known exactly.
+// Also replays residual histories into the progress estimator
+#include "solver.h"
+#include "progressestimator.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class Listener : public Solver::Listener {
+public:
+    void warning(const std::string &warning) override {fprintf(stderr, "Warning: %s\n", warning.c_str());}
+    void error(const std::string &error) override {fprintf(stderr, "Error: %s\n", error.c_str());}
+};
+
+static Shape rectangle(Shape::Type type, double x1, double y1, double x2, double y2, double epsilonR = 1.0)
+{
+    Shape s(type);
+    s.epsilonR = epsilonR;
+    s.vertices = {Point(x1, y1), Point(x2, y1), Point(x2, y2), Point(x1, y2)};
+    return s;
+}
+
+static int failures = 0;
+
+static void check(const std::string &name, double value, double expected, double tolerance)
+{
+    bool pass = std::abs(value / expected - 1) <= tolerance;
+    printf("%s %s: %g (expected %g)\n", pass ? "PASS" : "FAIL", name.c_str(), value, expected);
+    if(!pass) {
+        failures++;
+    }
+}
+
+// feeds a residual history into the progress estimator (one sample per iteration, 1ms each) up to the threshold.
+// The percentage must never decrease and the remaining iterations estimated at the given fraction of the history
+// must be close to the real count
+static void replay(const std::string &name, const std::vector<double> &residuals, double threshold, double fraction, double tolerance)
+{
+    unsigned int total = 0;
+    while(total < residuals.size() && residuals[total] > threshold) {
+        total++;
+    }
+    unsigned int checkpoint = total * fraction;
+
+    ProgressEstimator estimator;
+    estimator.reset(threshold);
+    double percent = 0;
+    bool increasing = true;
+    double remaining = -1;
+    for(unsigned int i=0;i<total;i++) {
+        estimator.addSample(i * 1e-3, i, residuals[i]);
+        if(estimator.getPercent() < percent) {
+            increasing = false;
+        }
+        percent = estimator.getPercent();
+        if(i == checkpoint) {
+            remaining = estimator.getRemainingIterations();
+        }
+    }
+    printf("%s %s: percentage never decreases\n", increasing ? "PASS" : "FAIL", name.c_str());
+    if(!increasing) {
+        failures++;
+    }
+    check(name+" remaining iterations", remaining, total - checkpoint, tolerance);
+}
+
+static void replayHistories()
+{
+    constexpr double threshold = 1e-6;
+    constexpr unsigned int length = 5000;
+    std::vector<double> geometric, noisy, accelerated;
+    for(unsigned int k=0;k<length;k++) {
+        // constant convergence rate
+        geometric.push_back(pow(0.98, k));
+        // same rate, but oscillating with occasional spikes (e.g. the pipelined workers or a restarted acceleration)
+        noisy.push_back(pow(0.98, k) * (1 + 0.6 * sin(0.9 * k)) * (k % 37 == 0 ? 5 : 1));
+        // slow start, then much faster once the acceleration is running
+        double slope = k < 200 ? -0.005 * k : -1.0 - 0.03 * (k - 200);
+        accelerated.push_back(exp(slope) * (1 + 0.3 * sin(0.5 * k)));
+    }
+    replay("geometric history", geometric, threshold, 0.5, 1e-2);
+    replay("noisy history", noisy, threshold, 0.5, 0.15);
+    replay("accelerated history", accelerated, threshold, 0.6, 0.15);
+}
+
+int main()
+{
+    replayHistories();
+
+    // the plates span the whole width and the borders are neumann, so the field is uniform. Both plate surfaces
+    // are between the cells to exercise the sub-cell boundaries
+    constexpr double width = 1e-3;
+    constexpr double gap = 100e-6;
+    constexpr double bottom = 12.3e-6;
+    constexpr double epsilonR = 4.0;
+    constexpr double grid = 10e-6;
+    // capacitance divided by e0, per meter
+    constexpr double expected = epsilonR * width / gap;
+
+    Geometry geometry;
+    geometry.addShape(rectangle(Shape::Type::GND, -width, -50e-6, width, bottom));
+    geometry.addShape(rectangle(Shape::Type::Dielectric, -width, bottom, width, bottom + gap, epsilonR));
+    auto trace = rectangle(Shape::Type::TracePos, -width, bottom + gap, width, bottom + gap + 50e-6);
+    trace.conductor = 1;
+    geometry.addShape(trace);
+
+    Listener listener;
+    auto configure = [&](Solver &s) {
+        s.setListener(&listener);
+        s.setArea(Point(-width / 2, 200e-6), Point(width / 2, -50e-6));
+        s.setGrid(grid, grid);
+        s.setThreads(2);
+        s.setThreshold(1e-9);
+        s.setGroundedBorders(false);
+    };
+
+    {
+        Solver s;
+        configure(s);
+        if(s.calculate(geometry)) {
+            check("zebra charge", s.getCharge(Shape::Type::TracePos), expected, 1e-2);
+            check("zebra energy", 2 * s.getEnergy(), expected, 1e-2);
+        } else {
+            printf("FAIL zebra calculation\n");
+            failures++;
+        }
+    }
+    {
+        Solver s;
+        configure(s);
+        s.setMethod(Solver::Method::GaussSeidel);
+        s.setAcceleration(Solver::Acceleration::None);
+        if(s.calculate(geometry)) {
+            check("gauss-seidel charge", s.getCharge(Shape::Type::TracePos), expected, 1e-2);
+        } else {
+            printf("FAIL gauss-seidel calculation\n");
+            failures++;
+        }
+    }
+    {
+        Solver s;
+        configure(s);
+        s.setMatrixExtraction(true);
+        if(s.calculate(geometry)) {
+            auto matrix = s.getChargeMatrix();
+            auto air = s.getAirChargeMatrix();
+            if(matrix.size() == 1 && air.size() == 1) {
+                check("matrix charge", matrix[0][0], expected, 1e-2);
+                check("matrix charge without dielectric", air[0][0], expected / epsilonR, 1e-2);
+            } else {
+                printf("FAIL matrix size %d\n", (int) matrix.size());
+                failures++;
+            }
+        } else {
+            printf("FAIL matrix calculation\n");
+            failures++;
+        }
+    }
+
+    printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,11 @@
+# Smoke test of the solver core, builds without Qt and returns nonzero if a check fails
+TEMPLATE = app
+CONFIG += console
+CONFIG -= qt app_bundle
+
+TARGET = smoketest
+
+include(../core.pri)
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,52 @@
+#ifndef INCLUDE_TUPLE_H
+#define INCLUDE_TUPLE_H
+
+#include <stdint.h>
+
+struct rect {
+    double x;
+    double y;
+};
+
+struct point {
+    uint32_t x;
+    uint32_t y;
+};
+
+enum method {
+    /* pipelined gauss-seidel, the workers follow each other through the rows */
+    METHOD_GAUSS_SEIDEL,
+    /* zebra line relaxation, whole rows are solved at once */
+    METHOD_ZEBRA,
+};
+
+enum acceleration {
+    ACCELERATION_NONE,
+    /* chebyshev semi-iteration on top of a symmetric zebra sweep */
+    ACCELERATION_CHEBYSHEV,
+    /* anderson mixing of the last iterates every few zebra sweeps */
+    ACCELERATION_ANDERSON,
+};
+
+typedef void (*message_callback_t)(void *ptr, const char *message);
+
+struct config {
+    uint8_t threads;
+    uint8_t distance;
+    double threshold;
+    enum method method;
+    enum acceleration acceleration;
+    /* number of previous iterates used by the anderson mixing */
+    uint8_t window;
+    /* number of sweeps between two evaluations of the quantity of interest (0 disables it) */
+    uint16_t interval;
+    /* number of evaluations the quantity of interest has to be stable for */
+    uint8_t span;
+    /* relative tolerance of the quantity of interest */
+    double tolerance;
+    /* receives the diagnostic messages of the computation, nothing is printed if NULL */
+    message_callback_t message;
+    void *message_ptr;
+};
+
+#endif
@@ -4,36 +4,7 @@
 #include <stdint.h>
 #include <pthread.h>
 
-typedef void (*progress_callback_t)(void *ptr, double current_diff);
-
-#include "lattice.h"
-#include "tuple.h"
-
-struct worker {
-    uint8_t id;
-    uint8_t done;
-    struct worker* previous;
-    struct worker* next;
-    struct lattice* lattice;
-    struct point pos;
-    uint32_t iterations;
-
-    struct config conf;
-
-    pthread_t thread;
-    pthread_spinlock_t lock, listLock;
-    pthread_mutex_t mutex;
-    pthread_cond_t cond;
-
-    progress_callback_t cb;
-    void *cb_ptr;
-};
-
-struct worker*
-worker_new(struct worker* next, struct lattice* lattice, struct config* conf, progress_callback_t cb, void *cb_ptr);
-
-void worker_delete(struct worker* worker);
-void* work(void* ptr);
+#include "worker.h"
 
 double iterate(struct worker* worker);
 
@@ -82,6 +53,8 @@ worker_new(struct worker* next, struct lattice* lattice, struct config* conf, pr
         worker->conf.distance  = next->conf.distance;
         worker->conf.threads   = next->conf.threads;
         worker->conf.threshold = next->conf.threshold;
+        worker->conf.message   = next->conf.message;
+        worker->conf.message_ptr = next->conf.message_ptr;
 
         /* insert ourself into the linked list */
         next->previous->next = worker;
@@ -107,12 +80,15 @@ worker_new(struct worker* next, struct lattice* lattice, struct config* conf, pr
         worker->conf.distance  = conf->distance;
         worker->conf.threads   = conf->threads;
         worker->conf.threshold = conf->threshold;
+        worker->conf.message   = conf->message;
+        worker->conf.message_ptr = conf->message_ptr;
     }
 
     /* initialize fields */
     worker->done = 0;
     worker->lattice = lattice;
     worker->iterations = 0;
+    monitor_init(&worker->monitor);
     worker->pos.x = 0;
     worker->pos.y = 0;
     worker->cb = cb;
@@ -149,8 +125,6 @@ void* work(void* ptr) {
     struct worker* worker = (struct worker*) ptr;
     double diff;
 
-    printf("Thread %2d: starting\n", worker->id);
-
     do {
         worker->iterations++;
         diff = iterate(worker);
@@ -158,6 +132,21 @@ void* work(void* ptr) {
             worker->cb(worker->cb_ptr, diff);
         }
 
+        /*
+         * give up if this is not going anywhere, only the first worker
+         * watches the differences (every worker sweeps the whole lattice)
+         * so the result is written by a single thread
+         */
+        if(worker->id == 1 && !worker->lattice->abort) {
+            enum result result = monitor_update(&worker->monitor, diff);
+            if(result != RESULT_NONE) {
+                worker->lattice->result = result;
+                worker->lattice->reached = worker->monitor.best;
+                worker->lattice->abort = true;
+                diff = 0;
+            }
+        }
+
         /* safely reset the y position */
         pthread_spin_lock(&worker->lock);
         worker->pos.y = 0;
@@ -175,16 +164,18 @@ void* work(void* ptr) {
         pthread_mutex_unlock(&worker->previous->mutex);
     }
 
-    printf("Thread %2d: finished with %d iterations\n",
-        worker->id, worker->iterations);
+    if(worker->conf.message) {
+        char message[64];
+        snprintf(message, sizeof(message), "Thread %2d: finished with %d iterations",
+            worker->id, worker->iterations);
+        worker->conf.message(worker->conf.message_ptr, message);
+    }
 
     /* wait for all the threads */
     if(worker->previous->id != 1) {
         pthread_join(worker->previous->thread, NULL);
     }
 
-    printf("Thread %2d: exiting\n", worker->id);
-
     return NULL;
 }
 
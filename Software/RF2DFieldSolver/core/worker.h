@@ -5,9 +5,11 @@
 #include <pthread.h>
 
 typedef void (*progress_callback_t)(void *ptr, double current_diff);
+typedef double (*quantity_callback_t)(void *ptr);
 
 #include "lattice.h"
 #include "tuple.h"
+#include "monitor.h"
 
 struct worker {
     uint8_t id;
@@ -17,6 +19,7 @@ struct worker {
     struct lattice* lattice;
     struct point pos;
     uint32_t iterations;
+    struct monitor monitor;
 
     struct config conf;
 
@@ -1,59 +1,13 @@
-#include <QObject>
-#include <QList>
-#include <QPointF>
-#include <QPolygonF>
-#include "savable.h"
-
-class Element : public QObject, public Savable
-{
-    Q_OBJECT
-public:
-    enum class Type {
-        Dielectric,
-        TracePos,
-        TraceNeg,
-        GND,
-        Last,
-    };
-
-    explicit Element(Type type);
-
-    virtual nlohmann::json toJSON() override;
-    virtual void fromJSON(nlohmann::json j) override;
-
-    static QString TypeToString(Type type);
-    static Type TypeFromString(QString s);
-    static QList<Type> getTypes();
-
-    QString getName() const {return name;}
-    Type getType() const {return type;}
-    double getEpsilonR() const {return epsilon_r;}
-    const QList<QPointF>& getVertices() const {return vertices;}
-    void addVertex(int index, QPointF vertex);
-    void appendVertex(QPointF vertex);
-    void removeVertex(int index);
-    void changeVertex(int index, QPointF newCoords);
-
-    void setName(QString s) {name = s;}
-    void setType(Type t);
-    void setEpsilonR(double er) {epsilon_r = er;}
-    QPolygonF toPolygon();
-
-signals:
-    void typeChanged();
-
-private:
-    QList<QPointF> vertices;
-    QString name;
-    Type type;
-    double epsilon_r;
-};
+#include "element.h"
+
 
 Element::Element(Type type)
     : QObject{nullptr},
       type(type)
 {
     epsilon_r = 4.3;
+    conductor = defaultConductor(type);
+    line = false;
     switch(type) {
     case Type::TracePos: name = "RF+"; break;
     case Type::TraceNeg: name = "RF-"; break;
@@ -69,6 +23,8 @@ nlohmann::json Element::toJSON()
     j["name"] = name.toStdString();
     j["type"] = TypeToString(type).toStdString();
     j["e_r"] = epsilon_r;
+    j["conductor"] = conductor;
+    j["line"] = line;
     nlohmann::json jvertices;
     for(auto &v : vertices) {
         nlohmann::json jvertex;
@@ -85,6 +41,9 @@ void Element::fromJSON(nlohmann::json j)
     name = QString::fromStdString(j.value("name", name.toStdString()));
     type = TypeFromString(QString::fromStdString(j.value("type", "")));
     epsilon_r = j.value("e_r", epsilon_r);
+    // older files only have one conductor per trace type
+    conductor = j.value("conductor", defaultConductor(type));
+    line = j.value("line", false);
     vertices.clear();
     if(j.contains("vertices")) {
         for(auto jvertex : j["vertices"]) {
@@ -154,9 +113,65 @@ void Element::changeVertex(int index, QPointF newCoords)
 void Element::setType(Type t)
 {
     type = t;
+    if(conductor < 1) {
+        conductor = defaultConductor(type);
+    }
     emit typeChanged();
 }
 
+int Element::getConductor() const
+{
+    switch(type) {
+    case Type::TracePos:
+    case Type::TraceNeg:
+        return conductor;
+    case Type::Dielectric:
+    case Type::GND:
+    case Type::Last:
+        break;
+    }
+    return 0;
+}
+
+void Element::setConductor(int conductor)
+{
+    if(conductor >= 1) {
+        this->conductor = conductor;
+    }
+}
+
+int Element::defaultConductor(Type type)
+{
+    switch(type) {
+    case Type::TracePos: return 1;
+    case Type::TraceNeg: return 2;
+    case Type::Dielectric:
+    case Type::GND:
+    case Type::Last:
+        break;
+    }
+    return 0;
+}
+
+bool Element::isLine() const
+{
+    // only conductors can be modelled without thickness
+    return line && type != Type::Dielectric;
+}
+
+Shape Element::toShape() const
+{
+    Shape s(type);
+    s.name = name.toStdString();
+    s.epsilonR = epsilon_r;
+    s.conductor = conductor;
+    s.line = line;
+    for(auto &v : vertices) {
+        s.vertices.push_back(Point(v.x(), v.y()));
+    }
+    return s;
+}
+
 QPolygonF Element::toPolygon()
 {
     auto ret = QPolygonF(vertices);
@@ -6,18 +6,13 @@
 #include <QPointF>
 #include <QPolygonF>
 #include "savable.h"
+#include "geometry.h"
 
 class Element : public QObject, public Savable
 {
     Q_OBJECT
 public:
-    enum class Type {
-        Dielectric,
-        TracePos,
-        TraceNeg,
-        GND,
-        Last,
-    };
+    using Type = Shape::Type;
 
     explicit Element(Type type);
 
@@ -31,7 +26,11 @@ public:
     QString getName() const {return name;}
     Type getType() const {return type;}
     double getEpsilonR() const {return epsilon_r;}
+    // traces with the same number are connected, GND and dielectrics have no conductor number
+    int getConductor() const;
     const QList<QPointF>& getVertices() const {return vertices;}
+    // open polyline conductor without thickness instead of a closed polygon
+    bool isLine() const;
     void addVertex(int index, QPointF vertex);
     void appendVertex(QPointF vertex);
     void removeVertex(int index);
@@ -40,16 +39,23 @@ public:
     void setName(QString s) {name = s;}
     void setType(Type t);
     void setEpsilonR(double er) {epsilon_r = er;}
+    void setConductor(int conductor);
+    void setLine(bool line) {this->line = line;}
     QPolygonF toPolygon();
+    // copy for the solver core
+    Shape toShape() const;
 
 signals:
     void typeChanged();
 
 private:
+    static int defaultConductor(Type type);
     QList<QPointF> vertices;
     QString name;
     Type type;
     double epsilon_r;
+    int conductor;
+    bool line;
 };
 
 #endif // ELEMENT_H
@@ -1,55 +1,3 @@
-#include <QAbstractTableModel>
-#include <QList>
-#include <QStyledItemDelegate>
-#include "element.h"
-#include "savable.h"
-
-class TypeDelegate : public QStyledItemDelegate
-{
-    Q_OBJECT
-    //QSize sizeHint ( const QStyleOptionViewItem & option, const QModelIndex & index ) const override;
-    QWidget *createEditor(QWidget * parent, const QStyleOptionViewItem & option, const QModelIndex & index) const override;
-    void setEditorData(QWidget * editor, const QModelIndex & index) const override;
-    void setModelData(QWidget * editor, QAbstractItemModel * model, const QModelIndex & index) const override;
-};
-
-class ElementList : public QAbstractTableModel, public Savable
-{
-    Q_OBJECT
-public:
-    explicit ElementList(QObject *parent = nullptr);
-
-    virtual nlohmann::json toJSON() override;
-    virtual void fromJSON(nlohmann::json j) override;
-
-    enum class Column {
-        Name,
-        Type,
-        EpsilonR,
-        Last,
-    };
-
-    void addElement(Element *e);
-    bool removeElement(Element *e, bool del = true);
-    bool removeElement(int index, bool del = true);
-    Element *elementAt(int index) const;
-    const QList<Element*> getElements() const {return elements;}
-    double getDielectricConstantAt(const QPointF &p);
-
-    int rowCount(const QModelIndex &parent) const override { Q_UNUSED(parent) return elements.size();}
-    int columnCount(const QModelIndex &parent) const override {Q_UNUSED(parent) return (int) Column::Last;}
-    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
-    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
-    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
-    Qt::ItemFlags flags(const QModelIndex &index) const override;
-
-private:
-
-    int findIndex(Element *e);
-
-    QList<Element*> elements;
-};
-
 #include "elementlist.h"
 
 #include <QComboBox>
@@ -93,7 +41,7 @@ void ElementList::addElement(Element *e)
     connect(e, &Element::typeChanged, this, [=](){
         auto i = findIndex(e);
         if(i != -1) {
-            emit dataChanged(index(i, (int) Column::EpsilonR), index(i, (int) Column::EpsilonR));
+            emit dataChanged(index(i, (int) Column::EpsilonR), index(i, (int) Column::Conductor));
         }
     });
     connect(e, &Element::destroyed, this, [=](){
@@ -138,27 +86,36 @@ Element *ElementList::elementAt(int index) const
     }
 }
 
-double ElementList::getDielectricConstantAt(const QPointF &p)
+Geometry ElementList::toGeometry() const
 {
-    for(unsigned int i=0;i<elements.size();i++) {
-        auto e = elements[i];
-        QPolygonF poly = QPolygonF(e->getVertices());
-        if(poly.containsPoint(p, Qt::OddEvenFill)) {
-            // this polygon defines the weight at these coordinates
-            switch(e->getType()) {
-            case Element::Type::GND:
-            case Element::Type::TracePos:
-            case Element::Type::TraceNeg:
-                return 1.0;
-            case Element::Type::Dielectric:
-                return e->getEpsilonR();
-            case Element::Type::Last:
-                return 1.0;
-            }
-        }
+    Geometry g;
+    for(auto e : elements) {
+        g.addShape(e->toShape());
+    }
+    return g;
+}
+
+bool ElementList::hasDielectric()
+{
+    return toGeometry().hasDielectric();
+}
+
+bool ElementList::check(QString &error, QStringList &warnings)
+{
+    std::string e;
+    std::vector<std::string> w;
+    bool valid = toGeometry().check(e, w);
+    error = QString::fromStdString(e);
+    for(auto &warning : w) {
+        warnings.append(QString::fromStdString(warning));
     }
-    // not found, we are in the air
-    return 1.0;
+    return valid;
+}
+
+QList<int> ElementList::getConductors()
+{
+    auto conductors = toGeometry().getConductors();
+    return QList<int>(conductors.begin(), conductors.end());
 }
 
 QVariant ElementList::data(const QModelIndex &index, int role) const
@@ -177,9 +134,21 @@ QVariant ElementList::data(const QModelIndex &index, int role) const
             } else {
                 return "";
             }
+        case Column::Conductor:
+            if(e->getConductor() > 0) {
+                return e->getConductor();
+            } else {
+                return "";
+            }
+        case Column::Line:
         case Column::Last: return QVariant();
         }
         break;
+    case Qt::CheckStateRole:
+        if((Column) col == Column::Line && e->getType() != Element::Type::Dielectric) {
+            return e->isLine() ? Qt::Checked : Qt::Unchecked;
+        }
+        return QVariant();
     default: return QVariant();
     }
     return QVariant();
@@ -198,6 +167,8 @@ QVariant ElementList::headerData(int section, Qt::Orientation orientation, int r
     case 0: return "Name";
     case 1: return "Type";
     case 2: return "εr";
+    case 3: return "Line";
+    case 4: return "Conductor";
     default: return QVariant();
     }
 }
@@ -219,9 +190,24 @@ bool ElementList::setData(const QModelIndex &index, const QVariant &value, int r
             } else {
                 return false;
             }
+        case Column::Conductor:
+            if(e->getConductor() > 0 && value.toInt() >= 1) {
+                e->setConductor(value.toInt());
+                return true;
+            } else {
+                return false;
+            }
+        case Column::Line:
         case Column::Last: return false;
         }
         break;
+    case Qt::CheckStateRole:
+        if((Column) col == Column::Line && e->getType() != Element::Type::Dielectric) {
+            e->setLine(value.toInt() == Qt::Checked);
+            emit dataChanged(index, index);
+            return true;
+        }
+        break;
     }
 
     return false;
@@ -239,6 +225,12 @@ Qt::ItemFlags ElementList::flags(const QModelIndex &index) const
     case Column::Name: editable = true; break;
     case Column::Type: editable = true; break;
     case Column::EpsilonR: editable = e->getType() == Element::Type::Dielectric; break;
+    case Column::Conductor: editable = e->getConductor() > 0; break;
+    case Column::Line:
+        if(e->getType() != Element::Type::Dielectric) {
+            flags |= Qt::ItemIsUserCheckable;
+        }
+        break;
     case Column::Last: break;
     }
     if (editable) {
@@ -29,6 +29,8 @@ public:
         Name,
         Type,
         EpsilonR,
+        Line,
+        Conductor,
         Last,
     };
 
@@ -37,7 +39,15 @@ public:
     bool removeElement(int index, bool del = true);
     Element *elementAt(int index) const;
     const QList<Element*> getElements() const {return elements;}
-    double getDielectricConstantAt(const QPointF &p);
+    // copy of all elements for the solver core, in the same order
+    Geometry toGeometry() const;
+    // true if at least one dielectric differs from air
+    bool hasDielectric();
+    // checks the elements before a calculation, false with the reason if they are not supported. Issues that do
+    // not prevent the calculation are added to the warnings
+    bool check(QString &error, QStringList &warnings);
+    // sorted numbers of all conductors (connected traces share a number)
+    QList<int> getConductors();
 
     int rowCount(const QModelIndex &parent) const override { Q_UNUSED(parent) return elements.size();}
     int columnCount(const QModelIndex &parent) const override {Q_UNUSED(parent) return (int) Column::Last;}
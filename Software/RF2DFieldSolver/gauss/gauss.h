@@ -12,7 +12,9 @@ class Gauss : public QObject
 public:
     explicit Gauss(QObject *parent = nullptr);
 
-    static double getCharge(Laplace *laplace, ElementList *list, Element *e, double gridSize, double distance);
+    // integrates several nested contours around the element in one pass and combines them (see Solver::getContourCharge).
+    // The list must be the one that was calculated, contours that touch or enclose other conductors are excluded
+    static double getCharge(Laplace *laplace, ElementList *list, Element *e, double gridSize, bool dielectric);
 
 signals:
     void info(QString info);
@@ -0,0 +1,347 @@
+#include "goalseek.h"
+
+#include "unit.h"
+
+#include <algorithm>
+
+GoalSeek::GoalSeek(QObject *parent)
+    : QObject{parent}
+{
+    gridX = 1e-5;
+    gridY = 1e-5;
+    threads = 1;
+    min = 0;
+    max = 0;
+    impedance = Impedance::SingleEnded;
+    target = 50;
+    tolerance = 0.1;
+    level = 0;
+    levelEvaluations = 0;
+    evaluations = 0;
+    running = false;
+    abortRequested = false;
+    list = nullptr;
+}
+
+QString GoalSeek::ImpedanceToString(Impedance i)
+{
+    switch(i) {
+    case Impedance::SingleEnded: return "Single ended";
+    case Impedance::Differential: return "Differential";
+    case Impedance::Odd: return "Odd mode";
+    case Impedance::Even: return "Even mode";
+    case Impedance::Common: return "Common mode";
+    case Impedance::Last: return "Invalid";
+    }
+    return "Invalid";
+}
+
+GoalSeek::Impedance GoalSeek::ImpedanceFromString(QString s)
+{
+    for(unsigned int i=0;i<(int) Impedance::Last;i++) {
+        if(s == ImpedanceToString((Impedance) i)) {
+            return (Impedance) i;
+        }
+    }
+    return Impedance::Last;
+}
+
+double GoalSeek::getImpedance(const Laplace::LineParameters &p, Impedance i)
+{
+    switch(i) {
+    case Impedance::SingleEnded: return p.capacitanceP > 0 ? p.impedanceP : p.impedanceN;
+    case Impedance::Differential: return p.impedanceDiff;
+    case Impedance::Odd: return p.modes.odd;
+    case Impedance::Even: return p.modes.even;
+    case Impedance::Common: return p.modes.common;
+    case Impedance::Last: break;
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+void GoalSeek::setElements(std::function<ElementList *(double)> create)
+{
+    if(running) {
+        return;
+    }
+    this->create = create;
+}
+
+void GoalSeek::setConfiguration(std::function<void (Laplace *)> configure)
+{
+    if(running) {
+        return;
+    }
+    this->configure = configure;
+}
+
+void GoalSeek::setArea(const QPointF &topLeft, const QPointF &bottomRight)
+{
+    if(running) {
+        return;
+    }
+    this->topLeft = topLeft;
+    this->bottomRight = bottomRight;
+}
+
+void GoalSeek::setGrid(double gridX, double gridY)
+{
+    if(running) {
+        return;
+    }
+    this->gridX = gridX;
+    this->gridY = gridY;
+}
+
+void GoalSeek::setThreads(int threads)
+{
+    if(running) {
+        return;
+    }
+    this->threads = std::max(1, threads);
+}
+
+void GoalSeek::setParameter(QString name, QString unit, double min, double max)
+{
+    if(running) {
+        return;
+    }
+    this->name = name;
+    this->unit = unit;
+    this->min = std::min(min, max);
+    this->max = std::max(min, max);
+}
+
+void GoalSeek::setTarget(Impedance impedance, double target, double tolerance)
+{
+    if(running) {
+        return;
+    }
+    this->impedance = impedance;
+    this->target = target;
+    this->tolerance = std::abs(tolerance);
+}
+
+bool GoalSeek::start()
+{
+    // the coarse grids still have to resolve the geometry roughly
+    constexpr double minLines = 50;
+    if(running || !create || max <= min) {
+        return false;
+    }
+    running = true;
+    abortRequested = false;
+    timer.start();
+
+    scales.clear();
+    double lines = std::min((bottomRight.x() - topLeft.x()) / gridX, (topLeft.y() - bottomRight.y()) / gridY);
+    for(double s : {4.0, 2.0}) {
+        if(lines / s >= minLines) {
+            scales.push_back(s);
+        }
+    }
+    scales.push_back(1.0);
+    level = 0;
+    levelEvaluations = 0;
+    evaluations = 0;
+    slope = std::numeric_limits<double>::quiet_NaN();
+    bestX = min;
+    bestF = std::numeric_limits<double>::infinity();
+    emit info("Searching "+name+" for a "+ImpedanceToString(impedance).toLower()+" impedance of "+Unit::ToString(target, "Ω", " ", 4)
+              +", "+QString::number(scales.size())+" grid levels");
+
+    // the first level starts with both ends of the range
+    evaluate(min);
+    return true;
+}
+
+void GoalSeek::abort()
+{
+    if(!running) {
+        return;
+    }
+    abortRequested = true;
+    if(current) {
+        current->abortCalculation();
+    }
+}
+
+void GoalSeek::evaluate(double value)
+{
+    // the last calculation is the initial value of this one
+    if(current) {
+        previous = std::move(current);
+    }
+    list = create(value);
+    if(!list) {
+        emit error("Failed to create the elements");
+        finish(false);
+        return;
+    }
+    current = std::make_unique<Laplace>();
+    auto l = current.get();
+    if(configure) {
+        configure(l);
+    }
+    l->setGrid(gridX * scales[level], gridY * scales[level]);
+    l->setArea(topLeft, bottomRight);
+    l->setThreads(threads);
+    l->setMatrixExtraction(true);
+    l->setInitialSolution(previous.get());
+    connect(l, &Laplace::warning, this, &GoalSeek::warning);
+    connect(l, &Laplace::error, this, &GoalSeek::error);
+    connect(l, &Laplace::calculationDone, this, [=](){
+        auto z = getImpedance(l->getLineParameters(), impedance);
+        discardList();
+        if(abortRequested) {
+            finish(false);
+            return;
+        }
+        evaluated(value, z);
+    });
+    connect(l, &Laplace::calculationAborted, this, [=](){
+        discardList();
+        finish(false);
+    });
+    if(!l->startCalculation(list)) {
+        discardList();
+        finish(false);
+    }
+}
+
+void GoalSeek::evaluated(double x, double z)
+{
+    // give up after this many solves
+    constexpr int maxEvaluations = 30;
+
+    evaluations++;
+    levelEvaluations++;
+    QString prefixes = unit == "m" ? "um " : " ";
+    emit info("    "+name+" = "+Unit::ToString(x, unit, prefixes, 6)+" ("+QString::number(scales[level])+"x grid): "
+              +Unit::ToString(z, "Ω", " ", 5));
+    if(std::isnan(z)) {
+        emit error("The "+ImpedanceToString(impedance).toLower()+" impedance is not available for these elements");
+        finish(false);
+        return;
+    }
+    double f = z - target;
+    if(std::abs(f) < std::abs(bestF)) {
+        bestX = x;
+        bestF = f;
+    }
+    if(levelEvaluations > 1 && x != lastX) {
+        slope = (f - lastF) / (x - lastX);
+    }
+    lastX = x;
+    lastF = f;
+
+    // coarse grids only need to get close, their impedance is off anyway
+    if(std::abs(f) <= tolerance * scales[level]) {
+        nextLevel(x, z);
+        return;
+    }
+    if(evaluations >= maxEvaluations) {
+        emit error("No convergence after "+QString::number(evaluations)+" solves");
+        finish(false);
+        return;
+    }
+
+    double next;
+    if(levelEvaluations == 1) {
+        b = x;
+        fb = f;
+        bracketed = false;
+        if(level == 0) {
+            next = max;
+        } else if(std::isfinite(slope) && slope != 0) {
+            // the root moves only a bit between the levels
+            next = std::clamp(x - f / slope, min, max);
+        } else {
+            next = std::clamp(x + (max - min) / 100, min, max);
+        }
+    } else {
+        if(bracketed) {
+            // illinois: the end that stays gets half its value, otherwise the secant only approaches from one side
+            if(f * fb < 0) {
+                a = b;
+                fa = fb;
+            } else {
+                fa /= 2;
+            }
+        } else {
+            a = b;
+            fa = fb;
+            bracketed = f * fa < 0;
+        }
+        b = x;
+        fb = f;
+        if(!bracketed && level == 0) {
+            emit error("The target impedance is not between the impedances at both ends of the range ("
+                       +Unit::ToString(fa + target, "Ω", " ", 4)+" and "+Unit::ToString(fb + target, "Ω", " ", 4)+")");
+            finish(false);
+            return;
+        }
+        next = b - fb * (b - a) / (fb - fa);
+        if(bracketed) {
+            if(std::abs(b - a) <= 1e-9 * (max - min)) {
+                // can not be refined any further on this grid
+                nextLevel(bestX, bestF + target);
+                return;
+            }
+            if(!(next > std::min(a, b) && next < std::max(a, b))) {
+                next = (a + b) / 2;
+            }
+        } else {
+            // still on one side of the target, extrapolate
+            next = std::clamp(next, min, max);
+            if(next == b || !std::isfinite(next)) {
+                emit error("The target impedance is not reached within the range");
+                finish(false);
+                return;
+            }
+        }
+    }
+    evaluate(next);
+}
+
+void GoalSeek::nextLevel(double root, double impedance)
+{
+    level++;
+    if(level >= scales.size()) {
+        QString prefixes = unit == "m" ? "um " : " ";
+        emit info("Goal seek done: "+name+" = "+Unit::ToString(root, unit, prefixes, 6)+" results in "+Unit::ToString(impedance, "Ω", " ", 5)
+                  +", "+QString::number(evaluations)+" solves, took "+QString::number(timer.elapsed() / 1000.0)+"s");
+        finish(true);
+        emit seekDone(root, impedance);
+        return;
+    }
+    levelEvaluations = 0;
+    bestF = std::numeric_limits<double>::infinity();
+    evaluate(root);
+}
+
+void GoalSeek::finish(bool success)
+{
+    running = false;
+    if(!success) {
+        if(abortRequested) {
+            emit warning("Goal seek aborted");
+        }
+        emit seekFailed();
+    }
+    // the fields need a lot of memory
+    current = nullptr;
+    previous = nullptr;
+}
+
+void GoalSeek::discardList()
+{
+    if(!list) {
+        return;
+    }
+    while(list->getElements().size()) {
+        list->removeElement(0);
+    }
+    delete list;
+    list = nullptr;
+}
@@ -0,0 +1,95 @@
+#ifndef GOALSEEK_H
+#define GOALSEEK_H
+
+#include <QObject>
+#include <QPointF>
+#include <QElapsedTimer>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "elementlist.h"
+#include "laplace/laplace.h"
+
+// Searches the value of one parameter that results in a target impedance. The root is bracketed and refined with
+// the secant method (illinois variant), first on coarse grids and on the configured one near the end. Every solve
+// starts from the fields of the previous one, so all values must share the area and the conductors
+class GoalSeek : public QObject
+{
+    Q_OBJECT
+public:
+    explicit GoalSeek(QObject *parent = nullptr);
+
+    enum class Impedance {
+        SingleEnded,
+        Differential,
+        Odd,
+        Even,
+        Common,
+        Last,
+    };
+
+    static QString ImpedanceToString(Impedance i);
+    static Impedance ImpedanceFromString(QString s);
+    // the selected impedance of the line parameters, NaN if not available
+    static double getImpedance(const Laplace::LineParameters &p, Impedance i);
+
+    // creates the elements for a value of the parameter
+    void setElements(std::function<ElementList*(double value)> create);
+    // applies the solver settings, the area, grid, threads and the conductor matrix are set by the goal seek
+    void setConfiguration(std::function<void(Laplace*)> configure);
+    void setArea(const QPointF &topLeft, const QPointF &bottomRight);
+    void setGrid(double gridX, double gridY);
+    void setThreads(int threads);
+    // the parameter (name and unit only for the messages) is searched within min and max, the impedances at both
+    // ends of the range must be on different sides of the target
+    void setParameter(QString name, QString unit, double min, double max);
+    void setTarget(Impedance impedance, double target, double tolerance);
+
+    bool start();
+    void abort();
+    bool isRunning() {return running;}
+
+signals:
+    void seekDone(double value, double impedance);
+    void seekFailed();
+    void info(QString info);
+    void warning(QString warning);
+    void error(QString error);
+
+private:
+    void evaluate(double value);
+    void evaluated(double value, double impedance);
+    void nextLevel(double root, double impedance);
+    void finish(bool success);
+    void discardList();
+    std::function<ElementList*(double)> create;
+    std::function<void(Laplace*)> configure;
+    QPointF topLeft, bottomRight;
+    double gridX, gridY;
+    int threads;
+    QString name, unit;
+    double min, max;
+    Impedance impedance;
+    double target, tolerance;
+    // grid scale of each level, the last one is the configured grid
+    std::vector<double> scales;
+    unsigned int level;
+    int levelEvaluations, evaluations;
+    // last two points of this level, the bracket [a, b] once the target is between them
+    double a, fa, b, fb;
+    bool bracketed;
+    double lastX, lastF;
+    // dZ/dvalue from the last two points, the first step of the next level
+    double slope;
+    double bestX, bestF;
+    bool running;
+    bool abortRequested;
+    QElapsedTimer timer;
+    // the calculation of the current value and the previous one, its fields are the initial value
+    std::unique_ptr<Laplace> current, previous;
+    ElementList *list;
+};
+
+#endif // GOALSEEK_H
@@ -1,342 +1,252 @@
-#include <QObject>
-#include <QPointF>
+#include "laplace.h"
 
-#include <pthread.h>
-
-#include "elementlist.h"
-#include "lattice.h"
-
-class Laplace : public QObject
+Laplace::Laplace(QObject *parent)
+    : QObject{parent},
+      forwarder(this)
 {
-    Q_OBJECT
-public:
-    explicit Laplace(QObject *parent = nullptr);
-
-    void setArea(const QPointF &topLeft, const QPointF &bottomRight);
-    void setGrid(double grid);
-    void setThreads(int threads);
-    void setThreshold(double threshold);
-    void setGroundedBorders(bool gnd);
-    void setIgnoreDielectric(bool ignore);
-
-    bool startCalculation(ElementList *list);
-    void abortCalculation();
-    double getPotential(const QPointF &p);
-    QLineF getGradient(const QPointF &p);
-    bool isResultReady() {return resultReady;}
-    void invalidateResult();
-
-    double weight(rect *pos);
-
-signals:
-    void percentage(int percent);
-    void calculationDone();
-    void calculationAborted();
-    void info(QString info);
-    void warning(QString warning);
-    void error(QString error);
+    solver.setListener(&forwarder);
+    threadStarted = false;
+}
 
-private:
-    QPointF coordFromRect(struct rect *pos);
-    struct rect coordToRect(const QPointF &pos);
-    bound* boundary(struct bound* bound, struct rect* pos);
-    static struct bound* boundaryTrampoline(void *ptr, struct bound* bound, struct rect* pos) {
-        return ((Laplace*)ptr)->boundary(bound, pos);
-    }
-    static double weightTrampoline(void *ptr, struct rect* pos) {
-        return ((Laplace*)ptr)->weight(pos);
-    }
-    void* calcThread();
-    static void* calcThreadTrampoline(void *ptr) {
-        return ((Laplace*)ptr)->calcThread();
-    }
-    void calcProgressFromDiff(double diff);
-    static void calcProgressFromDiffTrampoline(void *ptr, double diff) {
-        ((Laplace*)ptr)->calcProgressFromDiff(diff);
+Laplace::~Laplace()
+{
+    if(threadStarted) {
+        abortCalculation();
+        pthread_join(thread, nullptr);
     }
-    bool calculationRunning;
-    bool resultReady;
-    ElementList *list;
-    QPointF topLeft, bottomRight;
-    double grid;
-    int threads;
-    double threshold;
-    bool groundedBorders;
-    bool ignoreDielectric;
-    struct lattice *lattice;
-    int lastPercent;
-
-    pthread_t thread;
-};
-
-#include <QPolygonF>
+}
 
-Laplace::Laplace(QObject *parent)
-    : QObject{parent}
+QString Laplace::DielectricAveragingToString(DielectricAveraging a)
 {
-    calculationRunning = false;
-    resultReady = false;
-    list = nullptr;
-    grid = 1e-5;
-    threads = 1;
-    threshold = 1e-6;
-    lattice = nullptr;
-    groundedBorders = true;
-    ignoreDielectric = false;
+    switch(a) {
+    case DielectricAveraging::CellCenter: return "Cell center";
+    case DielectricAveraging::Arithmetic: return "Arithmetic";
+    case DielectricAveraging::Harmonic: return "Harmonic";
+    case DielectricAveraging::Last: return "";
+    }
+    return "";
 }
 
-void Laplace::setArea(const QPointF &topLeft, const QPointF &bottomRight)
+Laplace::DielectricAveraging Laplace::DielectricAveragingFromString(QString s)
 {
-    if(calculationRunning) {
-        return;
+    for(unsigned int i=0;i<(int) DielectricAveraging::Last;i++) {
+        if(s == DielectricAveragingToString((DielectricAveraging) i)) {
+            return (DielectricAveraging) i;
+        }
     }
-    this->topLeft = topLeft;
-    this->bottomRight = bottomRight;
+    return DielectricAveraging::Last;
 }
 
-void Laplace::setGrid(double grid)
+QString Laplace::MethodToString(Method m)
 {
-    if(calculationRunning) {
-        return;
-    }
-    if(grid > 0) {
-        this->grid = grid;
+    switch(m) {
+    case Method::GaussSeidel: return "Gauss-Seidel";
+    case Method::Zebra: return "Zebra line relaxation";
+    case Method::Last: return "";
     }
+    return "";
 }
 
-void Laplace::setThreads(int threads)
+Laplace::Method Laplace::MethodFromString(QString s)
 {
-    if(calculationRunning) {
-        return;
-    }
-    if(threads > 0) {
-        this->threads = threads;
+    for(unsigned int i=0;i<(int) Method::Last;i++) {
+        if(s == MethodToString((Method) i)) {
+            return (Method) i;
+        }
     }
+    return Method::Last;
 }
 
-void Laplace::setThreshold(double threshold)
+QString Laplace::AccelerationToString(Acceleration a)
 {
-    if(calculationRunning) {
-        return;
+    switch(a) {
+    case Acceleration::None: return "None";
+    case Acceleration::Chebyshev: return "Chebyshev";
+    case Acceleration::Anderson: return "Anderson";
+    case Acceleration::Last: return "";
     }
-    if (threshold > 0) {
-        this->threshold = threshold;
+    return "";
+}
+
+Laplace::Acceleration Laplace::AccelerationFromString(QString s)
+{
+    for(unsigned int i=0;i<(int) Acceleration::Last;i++) {
+        if(s == AccelerationToString((Acceleration) i)) {
+            return (Acceleration) i;
+        }
     }
+    return Acceleration::Last;
 }
 
-void Laplace::setGroundedBorders(bool gnd)
+QString Laplace::ChargeExtractionToString(ChargeExtraction c)
 {
-    if(calculationRunning) {
-        return;
+    switch(c) {
+    case ChargeExtraction::GaussContour: return "Gauss contour";
+    case ChargeExtraction::ConductorResidual: return "Conductor residual";
+    case ChargeExtraction::Last: return "";
     }
-    groundedBorders = gnd;
+    return "";
 }
 
-void Laplace::setIgnoreDielectric(bool ignore)
+Laplace::ChargeExtraction Laplace::ChargeExtractionFromString(QString s)
 {
-    if(calculationRunning) {
-        return;
+    for(unsigned int i=0;i<(int) ChargeExtraction::Last;i++) {
+        if(s == ChargeExtractionToString((ChargeExtraction) i)) {
+            return (ChargeExtraction) i;
+        }
     }
-    ignoreDielectric = ignore;
+    return ChargeExtraction::Last;
+}
+
+void Laplace::setArea(const QPointF &topLeft, const QPointF &bottomRight)
+{
+    solver.setArea(Point(topLeft.x(), topLeft.y()), Point(bottomRight.x(), bottomRight.y()));
+}
+
+void Laplace::setGrid(double grid)
+{
+    setGrid(grid, grid);
+}
+
+void Laplace::setGrid(double gridX, double gridY)
+{
+    solver.setGrid(gridX, gridY);
 }
 
 bool Laplace::startCalculation(ElementList *list)
 {
-    if(calculationRunning) {
+    if(!prepareCalculation(list)) {
         return false;
     }
-    calculationRunning = true;
-    resultReady = false;
-    lastPercent = 0;
-    emit info("Laplace calculation starting");
-    if(lattice) {
-        delete lattice;
-        lattice = nullptr;
-    }
-    this->list = list;
 
     // start the calculation thread
     auto err = pthread_create(&thread, nullptr, calcThreadTrampoline, this);
     if(err) {
         emit error("Failed to start laplace thread");
+        // release the prepared calculation without solving it
+        solver.abortCalculation();
+        solver.runCalculation();
         return false;
     }
+    threadStarted = true;
     emit info("Laplace thread started");
     return true;
 }
 
-void Laplace::abortCalculation()
+bool Laplace::calculate(ElementList *list)
 {
-    if(!calculationRunning) {
-        return;
+    if(!prepareCalculation(list)) {
+        return false;
     }
-    // request abort of calculation
-    lattice->abort = true;
+    calcThread();
+    return solver.isResultReady();
 }
 
-double Laplace::getPotential(const QPointF &p)
+void Laplace::setInitialSolution(Laplace *solution)
+{
+    solver.setInitialSolution(solution ? &solution->solver : nullptr);
+}
+
+bool Laplace::prepareCalculation(ElementList *list)
 {
-    if(!resultReady) {
-        return std::numeric_limits<double>::quiet_NaN();
+    if(solver.isCalculationRunning()) {
+        return false;
     }
-    auto pos = coordToRect(p);
-    // convert to integers and shift by the added outside boundary of NaNs
-    int index_x = round(pos.x) + 1;
-    int index_y = round(pos.y) + 1;
-    if(index_x < 0 || index_x >= (int) lattice->dim.x || index_y < 0 || index_y >= (int) lattice->dim.y) {
-        return std::numeric_limits<double>::quiet_NaN();
+    if(threadStarted) {
+        // the previous calculation is done, release its thread
+        pthread_join(thread, nullptr);
+        threadStarted = false;
     }
-    auto c = &lattice->cells[index_x+index_y*lattice->dim.x];
-    return c->value;
+    return solver.prepareCalculation(list->toGeometry());
+}
+
+double Laplace::getPotential(const QPointF &p)
+{
+    return solver.getPotential(Point(p.x(), p.y()));
 }
 
 QLineF Laplace::getGradient(const QPointF &p)
 {
-    QLineF ret = QLineF(p, p);
-    if(!resultReady) {
-        return ret;
+    auto gradient = getGradients({p})[0];
+    if(std::isnan(gradient.x()) || std::isnan(gradient.y())) {
+        return QLineF(p, p);
     }
-    auto pos = coordToRect(p);
-    // convert to integers and shift by the added outside boundary of NaNs
-    int index_x = floor(pos.x) + 1;
-    int index_y = floor(pos.y) + 1;
+    return QLineF(p, p + gradient);
+}
 
-    if(index_x < 0 || index_x + 1 >= (int) lattice->dim.x || index_y < 0 || index_y + 1>= (int) lattice->dim.y) {
-        return ret;
+QList<QPointF> Laplace::getGradients(const QList<QPointF> &points)
+{
+    std::vector<Point> converted;
+    converted.reserve(points.size());
+    for(auto &p : points) {
+        converted.push_back(Point(p.x(), p.y()));
+    }
+    QList<QPointF> ret;
+    ret.reserve(points.size());
+    for(auto &g : solver.getGradients(converted)) {
+        ret.append(QPointF(g.x, g.y));
     }
-    // calculate gradient
-    auto c_floor = &lattice->cells[index_x+index_y*lattice->dim.x];
-    auto c_x = &lattice->cells[index_x+1+index_y*lattice->dim.x];
-    auto c_y = &lattice->cells[index_x+(index_y+1)*lattice->dim.x];
-    auto grad_x = c_x->value - c_floor->value;
-    auto grad_y = c_y->value - c_floor->value;
-    ret.setP2(p + QPointF(grad_x, grad_y));
     return ret;
 }
 
-void Laplace::invalidateResult()
+double Laplace::getFieldStrength(const QPointF &p)
 {
-    resultReady = false;
+    return solver.getFieldStrength(Point(p.x(), p.y()));
 }
 
-QPointF Laplace::coordFromRect(rect *pos)
+QList<int> Laplace::getConductors()
 {
-    QPointF ret;
-    ret.rx() = pos->x * grid + topLeft.x();
-    ret.ry() = pos->y * grid + bottomRight.y();
-    return ret;
+    auto conductors = solver.getConductors();
+    return QList<int>(conductors.begin(), conductors.end());
 }
 
-struct rect Laplace::coordToRect(const QPointF &pos)
+QVector<QVector<double>> Laplace::getChargeMatrix()
 {
-    struct rect ret;
-    ret.x = (pos.x() - topLeft.x()) / grid;
-    ret.y = (pos.y() - bottomRight.y()) / grid;
+    QVector<QVector<double>> ret;
+    for(auto &row : solver.getChargeMatrix()) {
+        ret.append(QVector<double>(row.begin(), row.end()));
+    }
     return ret;
 }
 
-bound *Laplace::boundary(bound *bound, rect *pos)
+QVector<QVector<double>> Laplace::getAirChargeMatrix()
 {
-    auto coord = coordFromRect(pos);
-    bound->value = 0;
-    bound->cond = NONE;
-
-    bool isBorder = qFuzzyCompare(coord.x(), topLeft.x()) || qFuzzyCompare(coord.x(), bottomRight.x()) || qFuzzyCompare(coord.y(), topLeft.y()) || qFuzzyCompare(coord.y(), bottomRight.y());
+    QVector<QVector<double>> ret;
+    for(auto &row : solver.getAirChargeMatrix()) {
+        ret.append(QVector<double>(row.begin(), row.end()));
+    }
+    return ret;
+}
 
-    // handle borders
-    if(groundedBorders && isBorder) {
-        bound->value = 0;
-        bound->cond = DIRICHLET;
-        return bound;
-    } else {
-        // find the matching polygon
-        for(auto e : list->getElements()) {
-            if(e->getType() == Element::Type::Dielectric) {
-                // skip, dielectric has no influence on boundary and trace/GND should always take priority
-                continue;
-            }
-            QPolygonF poly = e->toPolygon();
-            if(poly.containsPoint(coord, Qt::OddEvenFill)) {
-                // this polygon defines the boundary at these coordinates
-                switch(e->getType()) {
-                case Element::Type::GND:
-                    bound->value = 0;
-                    bound->cond = DIRICHLET;
-                    return bound;
-                case Element::Type::TracePos:
-                    bound->value = 1.0;
-                    bound->cond = DIRICHLET;
-                    return bound;
-                case Element::Type::TraceNeg:
-                    bound->value = -1.0;
-                    bound->cond = DIRICHLET;
-                    return bound;
-                case Element::Type::Dielectric:
-                case Element::Type::Last:
-                    return bound;
-                }
-            }
-        }
+QVector<QVector<double>> Laplace::getCapacitanceMatrix()
+{
+    QVector<QVector<double>> ret;
+    for(auto &row : solver.getCapacitanceMatrix()) {
+        ret.append(QVector<double>(row.begin(), row.end()));
     }
-    return bound;
+    return ret;
 }
 
-double Laplace::weight(rect *pos)
+QVector<QVector<double>> Laplace::getInductanceMatrix()
 {
-    if(ignoreDielectric) {
-        return 1.0;
+    QVector<QVector<double>> ret;
+    for(auto &row : solver.getInductanceMatrix()) {
+        ret.append(QVector<double>(row.begin(), row.end()));
     }
+    return ret;
+}
 
-    auto coord = coordFromRect(pos);
-    return sqrt(list->getDielectricConstantAt(coord));
+bool Laplace::getPerturbedEnergy(ElementList *perturbed, double &energy, double &airEnergy)
+{
+    return solver.getPerturbedEnergy(perturbed->toGeometry(), energy, airEnergy);
 }
 
 void* Laplace::calcThread()
 {
-    emit info("Creating lattice");
-    struct rect size = {(bottomRight.x() - topLeft.x()) / grid, (topLeft.y() - bottomRight.y()) / grid};
-    struct point dim = {(uint32_t) ((bottomRight.x() - topLeft.x()) / grid), (uint32_t) ((topLeft.y() - bottomRight.y()) / grid)};
-    lattice = lattice_new(&size, &dim, &boundaryTrampoline, &weightTrampoline, this);
-    if(lattice) {
-        emit info("Lattice creation complete");
+    if(solver.runCalculation()) {
+        emit calculationDone();
     } else {
-        emit error("Lattice creation failed");
-        return nullptr;
-    }
-
-    struct config conf = {(uint8_t) threads, 10, threshold};
-    if(conf.threads > lattice->dim.y / 5) {
-        conf.threads = lattice->dim.y / 5;
-    }
-    conf.distance = lattice->dim.y / threads;
-    emit info("Starting calculation threads");
-    auto it = lattice_compute_threaded(lattice, &conf, calcProgressFromDiffTrampoline, this);
-    calculationRunning = false;
-    if(lattice->abort) {
-        emit warning("Laplace calculation aborted");
-        resultReady = false;
-        emit percentage(0);
         emit calculationAborted();
-    } else {
-        emit info("Laplace calculation complete, took "+QString::number(it)+" iterations");
-        resultReady = true;
-        emit percentage(100);
-        emit calculationDone();
     }
     return nullptr;
 }
-
-void Laplace::calcProgressFromDiff(double diff)
-{
-    // diff is expected to go down from 1.0 to the threshold with exponetial decay
-    double endTime = pow(-log(threshold), 6);
-    double currentTime = pow(-log(diff), 6);
-    double percent = currentTime * 100 / endTime;
-    if(percent > 100) {
-        percent = 100;
-    } else if(percent < lastPercent) {
-        percent = lastPercent;
-    }
-    lastPercent = percent;
-    emit percentage(percent);
-}
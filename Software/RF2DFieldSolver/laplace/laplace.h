@@ -3,36 +3,122 @@
 
 #include <QObject>
 #include <QPointF>
+#include <QLineF>
+#include <QVector>
 
 #include <pthread.h>
 
 #include "elementlist.h"
-#include "lattice.h"
+#include "solver.h"
 
+// Qt front end of the solver core: converts between the Qt types and the core, runs the calculation in its
+// own thread and forwards the messages and the progress as signals
 class Laplace : public QObject
 {
     Q_OBJECT
 public:
     explicit Laplace(QObject *parent = nullptr);
+    ~Laplace();
+
+    using DielectricAveraging = Solver::DielectricAveraging;
+    static QString DielectricAveragingToString(DielectricAveraging a);
+    static DielectricAveraging DielectricAveragingFromString(QString s);
+
+    using Method = Solver::Method;
+    static QString MethodToString(Method m);
+    static Method MethodFromString(QString s);
+
+    using Acceleration = Solver::Acceleration;
+    static QString AccelerationToString(Acceleration a);
+    static Acceleration AccelerationFromString(QString s);
+
+    using ChargeExtraction = Solver::ChargeExtraction;
+    static QString ChargeExtractionToString(ChargeExtraction c);
+    static ChargeExtraction ChargeExtractionFromString(QString s);
 
     void setArea(const QPointF &topLeft, const QPointF &bottomRight);
     void setGrid(double grid);
-    void setThreads(int threads);
-    void setThreshold(double threshold);
-    void setGroundedBorders(bool gnd);
-    void setIgnoreDielectric(bool ignore);
+    void setGrid(double gridX, double gridY);
+    void setThreads(int threads) {solver.setThreads(threads);}
+    void setThreshold(double threshold) {solver.setThreshold(threshold);}
+    void setGroundedBorders(bool gnd) {solver.setGroundedBorders(gnd);}
+    void setIgnoreDielectric(bool ignore) {solver.setIgnoreDielectric(ignore);}
+    void setDielectricAveraging(DielectricAveraging averaging) {solver.setDielectricAveraging(averaging);}
+    void setSubCellBoundaries(bool enabled) {solver.setSubCellBoundaries(enabled);}
+    void setMethod(Method method) {solver.setMethod(method);}
+    void setAcceleration(Acceleration acceleration) {solver.setAcceleration(acceleration);}
+    void setAndersonWindow(int window) {solver.setAndersonWindow(window);}
+    // stop as soon as the charge on the traces changes by less than the relative tolerance (0 disables it)
+    void setChargeConvergence(double tolerance) {solver.setChargeConvergence(tolerance);}
+    // solve on progressively finer grids (up to the configured one) until the time runs out, 0 disables it
+    void setTimeBudget(double seconds) {solver.setTimeBudget(seconds);}
+    // how the charge for the charge convergence and the time budget is determined
+    void setChargeExtraction(ChargeExtraction extraction) {solver.setChargeExtraction(extraction);}
+    // solve one excitation per conductor (1V on it, all others grounded) and extract the charge matrices
+    void setMatrixExtraction(bool enabled) {solver.setMatrixExtraction(enabled);}
 
     bool startCalculation(ElementList *list);
-    void abortCalculation();
+    // same as startCalculation, but runs in the calling thread and returns once it is done
+    bool calculate(ElementList *list);
+    void abortCalculation() {solver.abortCalculation();}
+    // the next conductor matrix calculation starts from the fields of an other one with the same conductors
+    // (e.g. a neighbouring point of a sweep) instead of zero. It must not be recalculated while this one runs
+    void setInitialSolution(Laplace *solution);
     double getPotential(const QPointF &p);
     QLineF getGradient(const QPointF &p);
-    bool isResultReady() {return resultReady;}
-    void invalidateResult();
-
-    double weight(rect *pos);
+    // gradients (V/m) at all points, bilinearly interpolated between central differences at the cells, NaN outside of the area
+    QList<QPointF> getGradients(const QList<QPointF> &points);
+    // magnitude of the electric field (V/m) at the closest cell and its mean over the area, NaN if there is no result
+    double getFieldStrength(const QPointF &p);
+    double getMeanFieldStrength() {return solver.getMeanFieldStrength();}
+    // writes the potential and the electric field of all cells as CSV
+    bool exportField(QString filename) {return solver.exportField(filename.toStdString());}
+    bool isResultReady() {return solver.isResultReady();}
+    // relative error of the trace charge estimated from the last two grids of a time budgeted calculation, NaN if not known
+    double getErrorEstimate() {return solver.getErrorEstimate();}
+    // charge (divided by e0, per meter) of all conductors of this type, from the stencil residuals
+    double getCharge(Element::Type type) {return solver.getCharge(type);}
+    // charge (divided by e0, per meter) of one conductor, from the stencil residuals
+    double getCharge(int conductor) {return solver.getCharge(conductor);}
+    // numbers of the conductors in the order of the matrix rows and columns
+    QList<int> getConductors();
+    // charge (divided by e0, per meter) on conductor i with 1V on conductor j, with and without dielectric
+    QVector<QVector<double>> getChargeMatrix();
+    QVector<QVector<double>> getAirChargeMatrix();
+    // capacitance matrix (F/m) and inductance matrix (H/m), empty if there is no matrix or the air matrix is singular
+    QVector<QVector<double>> getCapacitanceMatrix();
+    QVector<QVector<double>> getInductanceMatrix();
+    // impedances (ohm) of two coupled lines, a and b are indexes into the conductors, NaN if there is no matrix
+    using Modes = Solver::Modes;
+    Modes getModes(int a, int b) {return solver.getModes(a, b);}
+    // charges (divided by e0, per meter) of the traces at their potentials (+1V/-1V), from the conductor matrices
+    bool getTraceCharges(double &chargeP, double &chargeN, double &airChargeP, double &airChargeN) {
+        return solver.getTraceCharges(chargeP, chargeN, airChargeP, airChargeN);
+    }
+    // capacitance (F/m), inductance (H/m) and impedance (ohm) of the traces, from the conductor matrices if they were
+    // extracted, otherwise from the charges of the selected extraction. The residual extraction with dielectric needs
+    // the trace charges of a separate calculation without dielectric for the inductance
+    using LineParameters = Solver::LineParameters;
+    LineParameters getLineParameters(double airChargeP = std::numeric_limits<double>::quiet_NaN(),
+                                     double airChargeN = std::numeric_limits<double>::quiet_NaN()) {
+        return solver.getLineParameters(airChargeP, airChargeN);
+    }
+    // energy (divided by e0, per meter) stored in the field. Twice the energy is the sum of charge times potential,
+    // but only approximately (within a few percent) with sub-cell boundaries, their stencil is not symmetric
+    double getEnergy() {return solver.getEnergy();}
+    // same for the field without dielectric, only available after a conductor matrix calculation
+    double getAirEnergy() {return solver.getAirEnergy();}
+    // Energy of the fields with and without dielectric on the lattice of elements with changed dielectric constants,
+    // to first order without solving the changed problem (see Solver::getPerturbedEnergy). False if the elements
+    // differ in anything else. Only available after a conductor matrix calculation
+    bool getPerturbedEnergy(ElementList *perturbed, double &energy, double &airEnergy);
+    void invalidateResult() {solver.invalidateResult();}
+    Solver &getSolver() {return solver;}
 
 signals:
     void percentage(int percent);
+    // estimated remaining calculation time in seconds, negative if not known yet
+    void remainingTime(double seconds);
     void calculationDone();
     void calculationAborted();
     void info(QString info);
@@ -40,36 +126,29 @@ signals:
     void error(QString error);
 
 private:
-    QPointF coordFromRect(struct rect *pos);
-    struct rect coordToRect(const QPointF &pos);
-    bound* boundary(struct bound* bound, struct rect* pos);
-    static struct bound* boundaryTrampoline(void *ptr, struct bound* bound, struct rect* pos) {
-        return ((Laplace*)ptr)->boundary(bound, pos);
-    }
-    static double weightTrampoline(void *ptr, struct rect* pos) {
-        return ((Laplace*)ptr)->weight(pos);
-    }
+    // emits the messages of the solver as signals
+    class Forwarder : public Solver::Listener {
+    public:
+        Forwarder(Laplace *laplace) : laplace(laplace) {}
+        void info(const std::string &info) override {emit laplace->info(QString::fromStdString(info));}
+        void warning(const std::string &warning) override {emit laplace->warning(QString::fromStdString(warning));}
+        void error(const std::string &error) override {emit laplace->error(QString::fromStdString(error));}
+        void percentage(int percent) override {emit laplace->percentage(percent);}
+        void remainingTime(double seconds) override {emit laplace->remainingTime(seconds);}
+    private:
+        Laplace *laplace;
+    };
+    bool prepareCalculation(ElementList *list);
     void* calcThread();
     static void* calcThreadTrampoline(void *ptr) {
         return ((Laplace*)ptr)->calcThread();
     }
-    void calcProgressFromDiff(double diff);
-    static void calcProgressFromDiffTrampoline(void *ptr, double diff) {
-        ((Laplace*)ptr)->calcProgressFromDiff(diff);
-    }
-    bool calculationRunning;
-    bool resultReady;
-    ElementList *list;
-    QPointF topLeft, bottomRight;
-    double grid;
-    int threads;
-    double threshold;
-    bool groundedBorders;
-    bool ignoreDielectric;
-    struct lattice *lattice;
-    int lastPercent;
+    Solver solver;
+    Forwarder forwarder;
 
     pthread_t thread;
+    // a thread was started by startCalculation and has not been joined yet
+    bool threadStarted;
 };
 
 #endif // LAPLACE_H
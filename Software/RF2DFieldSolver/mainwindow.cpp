@@ -2,11 +2,21 @@
 #include "ui_mainwindow.h"
 
 #include <QScrollBar>
+#include <QFileDialog>
+#include <QSpinBox>
 
 #include <QDebug>
 #include <QVector>
 
-#include "polygon.h"
+#include <functional>
+
+#include "util.h"
+#include "CustomWidgets/informationbox.h"
+#include "CustomWidgets/siunitedit.h"
+#include "unit.h"
+#include "ui_sweepDialog.h"
+#include "ui_goalSeekDialog.h"
+#include "ui_monteCarloDialog.h"
 
 #include "Scenarios/scenario.h"
 
@@ -37,20 +47,66 @@ MainWindow::MainWindow(QWidget *parent)
     ui->resolution->setPrecision(4);
     ui->resolution->setValue(10e-6);
 
-    ui->gaussDistance->setUnit("m");
-    ui->gaussDistance->setPrefixes("um ");
-    ui->gaussDistance->setPrecision(4);
-    ui->gaussDistance->setValue(20e-6);
+    ui->resolutionY->setUnit("m");
+    ui->resolutionY->setPrefixes("um ");
+    ui->resolutionY->setPrecision(4);
+    ui->resolutionY->setValue(10e-6);
 
     ui->tolerance->setUnit("V");
     ui->tolerance->setPrefixes("pnum ");
     ui->tolerance->setPrecision(4);
     ui->tolerance->setValue(100e-9);
 
+    ui->chargeTolerance->setUnit("");
+    ui->chargeTolerance->setPrefixes("um ");
+    ui->chargeTolerance->setPrecision(4);
+    ui->chargeTolerance->setValue(100e-6);
+
+    ui->timeBudget->setUnit("s");
+    ui->timeBudget->setPrefixes(" ");
+    ui->timeBudget->setPrecision(3);
+    ui->timeBudget->setValue(0);
+
     ui->threads->setValue(20);
 
     ui->borderIsGND->setChecked(true);
 
+    for(unsigned int i=0;i<(int) Laplace::DielectricAveraging::Last;i++) {
+        ui->dielectricAveraging->addItem(Laplace::DielectricAveragingToString((Laplace::DielectricAveraging) i));
+    }
+    ui->dielectricAveraging->setCurrentIndex((int) Laplace::DielectricAveraging::Harmonic);
+
+    ui->subCellBoundaries->setChecked(true);
+
+    for(unsigned int i=0;i<(int) Laplace::Method::Last;i++) {
+        ui->method->addItem(Laplace::MethodToString((Laplace::Method) i));
+    }
+    ui->method->setCurrentIndex((int) Laplace::Method::Zebra);
+
+    for(unsigned int i=0;i<(int) Laplace::Acceleration::Last;i++) {
+        ui->acceleration->addItem(Laplace::AccelerationToString((Laplace::Acceleration) i));
+    }
+    ui->acceleration->setCurrentIndex((int) Laplace::Acceleration::Chebyshev);
+    connect(ui->method, &QComboBox::currentIndexChanged, this, [=](){
+        // acceleration is only available for the zebra solver
+        ui->acceleration->setEnabled(ui->method->currentIndex() == (int) Laplace::Method::Zebra);
+        ui->andersonWindow->setEnabled(ui->method->currentIndex() == (int) Laplace::Method::Zebra);
+    });
+
+    for(unsigned int i=0;i<(int) Laplace::ChargeExtraction::Last;i++) {
+        ui->chargeExtraction->addItem(Laplace::ChargeExtractionToString((Laplace::ChargeExtraction) i));
+    }
+    ui->chargeExtraction->setCurrentIndex((int) Laplace::ChargeExtraction::ConductorResidual);
+    // both excitations in one go, also gives the even mode
+    ui->conductorMatrix->setChecked(true);
+
+    separateAirCalculation = false;
+    airCalculation = false;
+    scenario = nullptr;
+    surrogateScenario = nullptr;
+    airChargeP = 0;
+    airChargeN = 0;
+
     ui->xleft->setUnit("m");
     ui->xleft->setPrefixes("um ");
     ui->xleft->setPrecision(4);
@@ -88,6 +144,11 @@ MainWindow::MainWindow(QWidget *parent)
     });
     ui->showPotential->setChecked(true);
 
+    connect(ui->showField, &QCheckBox::toggled, this, [=](bool enabled){
+        ui->view->setShowField(enabled);
+    });
+    ui->showField->setChecked(false);
+
     connect(ui->showGrid, &QCheckBox::toggled, this, [=](bool enabled){
         ui->view->setShowGrid(enabled);
     });
@@ -127,6 +188,15 @@ MainWindow::MainWindow(QWidget *parent)
     ui->impedanceDiff->setUnit("Ω");
     ui->impedanceDiff->setPrecision(4);
 
+    ui->impedanceOdd->setUnit("Ω");
+    ui->impedanceOdd->setPrecision(4);
+
+    ui->impedanceEven->setUnit("Ω");
+    ui->impedanceEven->setPrecision(4);
+
+    ui->impedanceComm->setUnit("Ω");
+    ui->impedanceComm->setPrecision(4);
+
     // save/load
     connect(ui->actionOpen, &QAction::triggered, this, [=](){
         openFromFileDialog("Load project", "RF 2D field solver files (*.RF2Dproj)");
@@ -135,6 +205,28 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->actionSave, &QAction::triggered, this, [=](){
         saveToFileDialog("Load project", "RF 2D field solver files (*.RF2Dproj)", ".RF2Dproj");
     });
+    connect(ui->actionSensitivities, &QAction::triggered, this, &MainWindow::computeSensitivities);
+    connect(ui->actionSweep, &QAction::triggered, this, &MainWindow::sweepParameters);
+    connect(ui->actionGoalSeek, &QAction::triggered, this, &MainWindow::seekImpedance);
+    connect(ui->actionMonteCarlo, &QAction::triggered, this, &MainWindow::analyzeTolerances);
+    connect(ui->actionSurrogate, &QAction::triggered, this, &MainWindow::buildSurrogate);
+    connect(ui->actionExportField, &QAction::triggered, this, [=](){
+        if(!laplace.isResultReady()) {
+            InformationBox::ShowError("Error", "No calculation result available, run the calculation first");
+            return;
+        }
+        auto filename = QFileDialog::getSaveFileName(nullptr, "Export field", "", "CSV files (*.csv)", nullptr, QFileDialog::DontUseNativeDialog);
+        if(filename.isEmpty()) {
+            // aborted selection
+            return;
+        }
+        if(!filename.endsWith(".csv")) {
+            filename.append(".csv");
+        }
+        if(!laplace.exportField(filename)) {
+            InformationBox::ShowError("Error", "Failed to export the field to "+filename);
+        }
+    });
 
     list = new ElementList();
     ui->table->setModel(list);
@@ -188,69 +280,188 @@ MainWindow::MainWindow(QWidget *parent)
     connect(&laplace, &Laplace::info, this, &MainWindow::info);
     connect(&laplace, &Laplace::warning, this, &MainWindow::warning);
     connect(&laplace, &Laplace::error, this, &MainWindow::error);
+
+    connectSweep(sweep);
+    connect(&sweep, &Sweep::pointDone, this, [=](int point){
+        auto r = sweep.getResult(point);
+        QString line = "    Point "+QString::number(point+1)+": ";
+        if(r.capacitanceP > 0 && r.capacitanceN > 0) {
+            line += "Zdiff = "+Unit::ToString(r.impedanceDiff, "Ω", " ", 4);
+        } else if(r.capacitanceP > 0) {
+            line += "Z = "+Unit::ToString(r.impedanceP, "Ω", " ", 4);
+        } else {
+            line += "Z = "+Unit::ToString(r.impedanceN, "Ω", " ", 4);
+        }
+        info(line);
+    });
+    connect(&sweep, &Sweep::sweepDone, this, [=](){
+        analysisStopped(&sweep);
+        if(sweep.exportTable(sweepFilename)) {
+            info("Sweep table written to "+sweepFilename);
+        } else {
+            InformationBox::ShowError("Error", "Failed to write the sweep table to "+sweepFilename);
+        }
+    });
+
+    connect(&goalSeek, &GoalSeek::info, this, &MainWindow::info);
+    connect(&goalSeek, &GoalSeek::warning, this, &MainWindow::warning);
+    connect(&goalSeek, &GoalSeek::error, this, &MainWindow::error);
+    connect(&goalSeek, &GoalSeek::seekDone, this, [=](double value, double){
+        analysisStopped(&goalSeek);
+        // switch to the elements with the found value
+        auto values = goalSeekNominal;
+        values[goalSeekParameter] = value;
+        scenario->setParameterValues(values);
+        scenario->apply();
+    });
+    connect(&goalSeek, &GoalSeek::seekFailed, this, [=](){
+        analysisStopped(&goalSeek);
+        scenario->setParameterValues(goalSeekNominal);
+    });
+
+    connectSweep(monteCarloSweep);
+    connect(&monteCarloSweep, &Sweep::sweepDone, this, [=](){
+        analysisStopped(&monteCarloSweep);
+        double nominal = GoalSeek::getImpedance(monteCarloSweep.getResult(0), monteCarloImpedance);
+        std::vector<double> impedances;
+        for(int i=1;i<monteCarloSweep.getPoints();i++) {
+            impedances.push_back(GoalSeek::getImpedance(monteCarloSweep.getResult(i), monteCarloImpedance));
+        }
+        auto s = MonteCarlo::evaluate(impedances);
+        auto Z = [](double value) -> QString {
+            return Unit::ToString(value, "Ω", " ", 4);
+        };
+        info(GoalSeek::ImpedanceToString(monteCarloImpedance)+" impedance of "+QString::number(s.samples)+" samples (nominal "+Z(nominal)+"):");
+        if(s.samples < (int) impedances.size()) {
+            warning(QString::number(impedances.size() - s.samples)+" samples failed and are not included");
+        }
+        info("    Mean: "+Z(s.mean)+", standard deviation: "+Z(s.deviation)+", range: "+Z(s.min)+" to "+Z(s.max));
+        QString line = "    Percentiles:";
+        for(auto &p : s.percentiles) {
+            line += " P"+QString::number(p.first)+" = "+Z(p.second);
+        }
+        info(line);
+    });
+
+    connectSweep(sensitivitySweep);
+    connect(&sensitivitySweep, &Sweep::sweepDone, this, [=](){
+        analysisStopped(&sensitivitySweep);
+        double Z = GoalSeek::getImpedance(sensitivitySweep.getResult(0), sensitivityImpedance);
+        info("Sensitivities to the dimensions ("+Unit::ToString(Z, "Ω", " ", 4)+" on the common area):");
+        for(int i=0;i<sensitivityDimensions.size();i++) {
+            auto &d = sensitivityDimensions[i];
+            double lower = GoalSeek::getImpedance(sensitivitySweep.getResult(1 + 2 * i), sensitivityImpedance);
+            double upper = GoalSeek::getImpedance(sensitivitySweep.getResult(2 + 2 * i), sensitivityImpedance);
+            double dZ = (upper - lower) / (2 * d.step);
+            if(std::isnan(dZ)) {
+                warning("Failed to evaluate the sensitivity to \""+d.name+"\"");
+            } else {
+                reportSensitivity(d.name, d.unit, d.value, Z, dZ);
+            }
+        }
+    });
+
+    connectSweep(surrogateSweep);
+    connect(&surrogateSweep, &Sweep::sweepDone, this, [=](){
+        analysisStopped(&surrogateSweep);
+        int failed = 0;
+        for(int i=0;i<surrogateSweep.getPoints();i++) {
+            auto r = surrogateSweep.getResult(i);
+            if(std::isnan(r.capacitanceP) && std::isnan(r.capacitanceN)) {
+                failed++;
+            }
+            surrogateTable.setResult(i, r);
+        }
+        if(failed) {
+            warning(QString::number(failed)+" nodes of the table failed, the predictions around them are not available");
+        }
+        auto filename = Surrogate::tableFilename(surrogateTable.getScenario());
+        if(surrogateTable.save(filename)) {
+            info("Surrogate table written to "+filename);
+        } else {
+            InformationBox::ShowError("Error", "Failed to write the surrogate table to "+filename);
+        }
+        surrogateScenario->setSolverSettings(surrogateSettings());
+        surrogateScenario->setSurrogate(surrogateTable);
+    });
+
     connect(&laplace, &Laplace::calculationDone, this, [=](){
+        if(airCalculation) {
+            // keep the charges of the air field and continue with the dielectric
+            airChargeP = laplace.getCharge(Element::Type::TracePos);
+            airChargeN = -laplace.getCharge(Element::Type::TraceNeg);
+            info("Air calculation done, starting calculation with dielectric");
+            airCalculation = false;
+            laplace.setIgnoreDielectric(false);
+            laplace.startCalculation(list);
+            return;
+        }
         // laplace is done
         disconnect(&laplace, &Laplace::percentage, this, nullptr);
+        disconnect(&laplace, &Laplace::remainingTime, this, nullptr);
+        ui->progress->setFormat("%p%");
         disconnect(ui->abort, nullptr, &laplace, nullptr);
 
         ui->view->update();
-        // start gauss calculation
-        info("Starting gauss integration for charge without dielectric");
-        double chargeSumP = 0, chargeSumN = 0;
-        for(auto e : list->getElements()) {
-            switch(e->getType()) {
-            case Element::Type::TracePos:
-                chargeSumP += Gauss::getCharge(&laplace, nullptr, e, ui->resolution->value(), ui->gaussDistance->value());
-                break;
-            case Element::Type::TraceNeg:
-                chargeSumN -= Gauss::getCharge(&laplace, nullptr, e, ui->resolution->value(), ui->gaussDistance->value());
-                break;
-            case Element::Type::GND:
-            case Element::Type::Dielectric:
-            case Element::Type::Last:
-                break;
+        if(ui->conductorMatrix->isChecked()) {
+            auto conductors = laplace.getConductors();
+            auto printMatrix = [=](QString name, const QVector<QVector<double>> &m, QString unit) {
+                QStringList numbers;
+                for(auto c : conductors) {
+                    numbers.append(QString::number(c));
+                }
+                info(name+" (conductors "+numbers.join(", ")+"):");
+                for(auto &row : m) {
+                    QStringList values;
+                    for(auto v : row) {
+                        values.append(Unit::ToString(v, unit, "fpnum ", 4));
+                    }
+                    info("    "+values.join("    "));
+                }
+            };
+            printMatrix("Capacitance matrix", laplace.getCapacitanceMatrix(), "F/m");
+            auto L = laplace.getInductanceMatrix();
+            if(L.isEmpty()) {
+                warning("Capacitance matrix without dielectric is singular, inductance matrix not available");
+            } else {
+                printMatrix("Inductance matrix", L, "H/m");
             }
         }
-        info("Air gauss calculation done");
-        auto CairP = chargeSumP * e0;
-        auto LP = 1.0 / (std::pow(2.998e8, 2.0) * CairP);
-        ui->inductanceP->setValue(LP);
-
-        auto CairN = chargeSumN * e0;
-        auto LN = 1.0 / (std::pow(2.998e8, 2.0) * CairN);
-        ui->inductanceN->setValue(LN);
-
-        // start gauss calculation
-        info("Starting gauss integration for charge with dielectric");
-        chargeSumP = 0, chargeSumN = 0;
-        for(auto e : list->getElements()) {
-            switch(e->getType()) {
-            case Element::Type::TracePos:
-                chargeSumP += Gauss::getCharge(&laplace, list, e, ui->resolution->value(), ui->gaussDistance->value());
-                break;
-            case Element::Type::TraceNeg:
-                chargeSumN -= Gauss::getCharge(&laplace, list, e, ui->resolution->value(), ui->gaussDistance->value());
-                break;
-            case Element::Type::GND:
-            case Element::Type::Dielectric:
-            case Element::Type::Last:
-                break;
+        // the charges of the air calculation are only used by the residual extraction with dielectric
+        auto p = laplace.getLineParameters(airChargeP, airChargeN);
+        ui->inductanceP->setValue(p.inductanceP);
+        ui->inductanceN->setValue(p.inductanceN);
+        ui->capacitanceP->setValue(p.capacitanceP);
+        ui->capacitanceN->setValue(p.capacitanceN);
+        ui->impedanceP->setValue(p.impedanceP);
+        ui->impedanceN->setValue(p.impedanceN);
+        auto modes = p.getModes();
+        ui->impedanceDiff->setValue(modes.differential);
+        ui->impedanceOdd->setValue(modes.odd);
+        ui->impedanceEven->setValue(modes.even);
+        ui->impedanceComm->setValue(modes.common);
+
+        // cross-check with the field energy, 2W is the sum of the charges times the trace potentials (+1V/-1V). This
+        // only holds exactly for a symmetric stencil, the sub-cell boundaries alone cause a deviation of a few percent
+        constexpr double maxEnergyDeviation = 0.1;
+        auto Cenergy = 2 * laplace.getEnergy() * e0;
+        auto Ccharge = p.capacitanceP + p.capacitanceN;
+        if(Ccharge > 0 && !std::isnan(Cenergy)) {
+            auto deviation = std::abs(Cenergy / Ccharge - 1);
+            auto message = "Capacitance from field energy: "+Unit::ToString(Cenergy, "F/m", "fpnum ", 4)+" (from charge: "+Unit::ToString(Ccharge, "F/m", "fpnum ", 4)
+                 +", deviation "+QString::number(deviation * 100, 'g', 2)+"%)";
+            if(deviation > maxEnergyDeviation) {
+                warning(message);
+            } else {
+                info(message);
             }
         }
-        info("Dielectric gauss calculation done");
-        auto CdielectricP = chargeSumP * e0;
-        ui->capacitanceP->setValue(CdielectricP);
-
-        auto CdielectricN = chargeSumN * e0;
-        ui->capacitanceN->setValue(CdielectricN);
-
-        auto impedanceP = sqrt(ui->inductanceP->value() / CdielectricP);
-        ui->impedanceP->setValue(impedanceP);
-
-        auto impedanceN = sqrt(ui->inductanceN->value() / CdielectricN);
-        ui->impedanceN->setValue(impedanceN);
 
-        ui->impedanceDiff->setValue(ui->impedanceP->value() + ui->impedanceN->value());
+        auto error = laplace.getErrorEstimate();
+        if(ui->timeBudget->value() > 0 && !std::isnan(error)) {
+            // Z = 1/(c*sqrt(Cair*C)), the relative errors of C and Z are about the same
+            info("Estimated discretization error of C/L/Z: "+QString::number(error * 100, 'g', 2)+"%");
+        }
 
         // calculation complete
         ui->progress->setValue(100);
@@ -261,6 +472,9 @@ MainWindow::MainWindow(QWidget *parent)
     });
 
     auto calculationAborted = [=](){
+        disconnect(&laplace, &Laplace::percentage, this, nullptr);
+        disconnect(&laplace, &Laplace::remainingTime, this, nullptr);
+        ui->progress->setFormat("%p%");
         ui->progress->setValue(0);
         calculationStopped();
         ui->view->update();
@@ -273,6 +487,7 @@ MainWindow::MainWindow(QWidget *parent)
         auto action = new QAction(s->getName());
         ui->menuPredefined_Scenarios->addAction(action);
         connect(action, &QAction::triggered, this, [=](){
+            s->setSolverSettings(surrogateSettings());
             s->show();
         });
         connect(s, &Scenario::scenarioCreated, this, [=](QPointF topLeft, QPointF bottomRight, ElementList *list){
@@ -286,6 +501,10 @@ MainWindow::MainWindow(QWidget *parent)
             delete this->list;
             this->list = list;
             ui->table->setModel(list);
+            scenario = s;
+            // the result belongs to the old elements
+            laplace.invalidateResult();
+            ui->view->update();
         });
     }
 }
@@ -306,15 +525,26 @@ nlohmann::json MainWindow::toJSON()
     j["viewGrid"] = ui->gridsize->value();
     // store view settings
     j["showPotential"] = ui->showPotential->isChecked();
+    j["showField"] = ui->showField->isChecked();
     j["showGrid"] = ui->showGrid->isChecked();
     j["snapToGrid"] = ui->snapGrid->isChecked();
     j["viewMode"] = ui->viewMode->currentText().toStdString();
     // store simulation parameters
     j["simulationGrid"] = ui->resolution->value();
-    j["gaussDistance"] = ui->gaussDistance->value();
+    j["simulationGridY"] = ui->resolutionY->value();
     j["tolerance"] = ui->tolerance->value();
     j["threads"] = ui->threads->value();
     j["borderIsGND"] = ui->borderIsGND->isChecked();
+    j["dielectricAveraging"] = ui->dielectricAveraging->currentText().toStdString();
+    j["subCellBoundaries"] = ui->subCellBoundaries->isChecked();
+    j["method"] = ui->method->currentText().toStdString();
+    j["acceleration"] = ui->acceleration->currentText().toStdString();
+    j["andersonWindow"] = ui->andersonWindow->value();
+    j["chargeConvergence"] = ui->chargeConvergence->isChecked();
+    j["chargeTolerance"] = ui->chargeTolerance->value();
+    j["timeBudget"] = ui->timeBudget->value();
+    j["chargeExtraction"] = ui->chargeExtraction->currentText().toStdString();
+    j["conductorMatrix"] = ui->conductorMatrix->isChecked();
     // store elements
     j["list"] = list->toJSON();
     return j;
@@ -330,19 +560,34 @@ void MainWindow::fromJSON(nlohmann::json j)
     ui->gridsize->setValue(j.value("viewGrid", ui->gridsize->value()));
     // load view settings
     ui->showPotential->setChecked(j.value("showPotential", ui->showPotential->isChecked()));
+    ui->showField->setChecked(j.value("showField", ui->showField->isChecked()));
     ui->showGrid->setChecked(j.value("showGrid", ui->showGrid->isChecked()));
     ui->snapGrid->setChecked(j.value("snapToGrid", ui->snapGrid->isChecked()));
     ui->viewMode->setCurrentText(QString::fromStdString(j.value("viewMode", ui->viewMode->currentText().toStdString())));
     // load simulation parameters
     ui->resolution->setValue(j.value("simulationGrid", ui->resolution->value()));
-    ui->gaussDistance->setValue(j.value("gaussDistance", ui->gaussDistance->value()));
+    // older files only have one grid resolution for both directions
+    ui->resolutionY->setValue(j.value("simulationGridY", ui->resolution->value()));
     ui->tolerance->setValue(j.value("tolerance", ui->tolerance->value()));
     ui->threads->setValue(j.value("threads", ui->threads->value()));
     ui->borderIsGND->setChecked(j.value("borderIsGND", ui->borderIsGND->isChecked()));
+    // older files were evaluated with the legacy discretization and solver, keep their results
+    ui->dielectricAveraging->setCurrentText(QString::fromStdString(j.value("dielectricAveraging", Laplace::DielectricAveragingToString(Laplace::DielectricAveraging::CellCenter).toStdString())));
+    ui->subCellBoundaries->setChecked(j.value("subCellBoundaries", false));
+    ui->method->setCurrentText(QString::fromStdString(j.value("method", Laplace::MethodToString(Laplace::Method::GaussSeidel).toStdString())));
+    ui->acceleration->setCurrentText(QString::fromStdString(j.value("acceleration", Laplace::AccelerationToString(Laplace::Acceleration::None).toStdString())));
+    ui->andersonWindow->setValue(j.value("andersonWindow", ui->andersonWindow->value()));
+    ui->chargeConvergence->setChecked(j.value("chargeConvergence", ui->chargeConvergence->isChecked()));
+    ui->chargeTolerance->setValue(j.value("chargeTolerance", ui->chargeTolerance->value()));
+    ui->timeBudget->setValue(j.value("timeBudget", ui->timeBudget->value()));
+    // older files were evaluated with the contour integration
+    ui->chargeExtraction->setCurrentText(QString::fromStdString(j.value("chargeExtraction", Laplace::ChargeExtractionToString(Laplace::ChargeExtraction::GaussContour).toStdString())));
+    ui->conductorMatrix->setChecked(j.value("conductorMatrix", false));
     // load elements
     if(j.contains("list")) {
         list->fromJSON(j["list"]);
     }
+    scenario = nullptr;
 }
 
 void MainWindow::info(QString info)
@@ -391,10 +636,20 @@ void MainWindow::startCalculation()
     ui->ytop->setEnabled(false);
     ui->ybottom->setEnabled(false);
     ui->resolution->setEnabled(false);
-    ui->gaussDistance->setEnabled(false);
+    ui->resolutionY->setEnabled(false);
     ui->threads->setEnabled(false);
     ui->tolerance->setEnabled(false);
     ui->borderIsGND->setEnabled(false);
+    ui->dielectricAveraging->setEnabled(false);
+    ui->subCellBoundaries->setEnabled(false);
+    ui->method->setEnabled(false);
+    ui->acceleration->setEnabled(false);
+    ui->andersonWindow->setEnabled(false);
+    ui->chargeConvergence->setEnabled(false);
+    ui->chargeTolerance->setEnabled(false);
+    ui->timeBudget->setEnabled(false);
+    ui->chargeExtraction->setEnabled(false);
+    ui->conductorMatrix->setEnabled(false);
     ui->add->setEnabled(false);
     ui->remove->setEnabled(false);
 
@@ -407,102 +662,659 @@ void MainWindow::startCalculation()
     ui->inductanceN->setValue(std::numeric_limits<double>::quiet_NaN());
     ui->impedanceN->setValue(std::numeric_limits<double>::quiet_NaN());
     ui->impedanceDiff->setValue(std::numeric_limits<double>::quiet_NaN());
+    ui->impedanceOdd->setValue(std::numeric_limits<double>::quiet_NaN());
+    ui->impedanceEven->setValue(std::numeric_limits<double>::quiet_NaN());
+    ui->impedanceComm->setValue(std::numeric_limits<double>::quiet_NaN());
 
     laplace.invalidateResult();
     ui->view->update();
     // TODO sanity check elements
 
-    // check for self-intersecting polygons
-    for(auto e : list->getElements()) {
-        if(Polygon::selfIntersects(e->getVertices())) {
-            error("Element \""+e->getName()+"\" self intersects, this is not supported");
-            calculationStopped();
-            return;
+    QString checkError;
+    QStringList checkWarnings;
+    bool valid = list->check(checkError, checkWarnings);
+    for(auto &w : checkWarnings) {
+        warning(w);
+    }
+    if(!valid) {
+        error(checkError);
+        calculationStopped();
+        return;
+    }
+
+    // the residual charges need a separate calculation without dielectric if there is one (the matrix extraction does both in one go)
+    separateAirCalculation = ui->chargeExtraction->currentIndex() == (int) Laplace::ChargeExtraction::ConductorResidual && list->hasDielectric()
+            && !ui->conductorMatrix->isChecked();
+    airCalculation = separateAirCalculation;
+
+    connect(&laplace, &Laplace::percentage, this, [=](int percent){
+        // the air calculation uses the first half of the progress
+        int minPercent = separateAirCalculation && !airCalculation ? 50 : 0;
+        int maxPercent = airCalculation ? 49 : 99;
+        ui->progress->setValue(percent * (maxPercent-minPercent) / 100 + minPercent);
+    });
+    connect(&laplace, &Laplace::remainingTime, this, [=](double seconds){
+        if(seconds < 0) {
+            ui->progress->setFormat("%p%");
+        } else {
+            ui->progress->setFormat("%p% (about "+QString::number(ceil(seconds))+"s left)");
         }
+    });
+    connect(ui->abort, &QPushButton::clicked, &laplace, &Laplace::abortCalculation);
+
+    // Start the dielectric laplace calculation
+    laplace.setArea(ui->view->getTopLeft(), ui->view->getBottomRight());
+    solverConfiguration()(&laplace);
+    laplace.setThreads(ui->threads->value());
+    laplace.setChargeConvergence(ui->chargeConvergence->isChecked() ? ui->chargeTolerance->value() : 0);
+    laplace.setTimeBudget(ui->timeBudget->value());
+    laplace.setMatrixExtraction(ui->conductorMatrix->isChecked());
+    laplace.setIgnoreDielectric(airCalculation);
+    laplace.startCalculation(list);
+    ui->view->update();
+}
+
+void MainWindow::computeSensitivities()
+{
+    auto energy = laplace.getEnergy();
+    auto airEnergy = laplace.getAirEnergy();
+    if(std::isnan(energy) || std::isnan(airEnergy)) {
+        InformationBox::ShowError("Error", "The sensitivities need the result of a calculation with the conductor matrix, run it first");
+        return;
     }
-    // check for short circuits between RF and GND
-    for(auto e1 : list->getElements()) {
-        if(e1->getType() != Element::Type::GND) {
-            continue;
+    bool hasP = false, hasN = false;
+    for(auto e : list->getElements()) {
+        hasP |= e->getType() == Element::Type::TracePos;
+        hasN |= e->getType() == Element::Type::TraceNeg;
+    }
+    double Z = hasP && hasN ? ui->impedanceDiff->value() : (hasP ? ui->impedanceP->value() : ui->impedanceN->value());
+
+    auto discard = [](ElementList *l) {
+        while(l->getElements().size()) {
+            l->removeElement(0);
+        }
+        delete l;
+    };
+    // Z is proportional to 1/sqrt(W*Wair), central difference of the energies with the converged fields. This is only
+    // correct to first order for the dielectric constants, moving the shapes also changes the fields at their boundaries
+    // (the dimensions are solved again instead)
+    auto derivative = [&](std::function<ElementList*(double)> create, double value, double step, double &dZ) -> bool {
+        double W[2], Wair[2];
+        for(int i=0;i<2;i++) {
+            auto perturbed = create(i ? value + step : value - step);
+            bool success = perturbed && laplace.getPerturbedEnergy(perturbed, W[i], Wair[i]);
+            if(perturbed) {
+                discard(perturbed);
+            }
+            if(!success) {
+                return false;
+            }
         }
-        for(auto e2 : list->getElements()) {
-            if(e2->getType() != Element::Type::TracePos && e2->getType() != Element::Type::TraceNeg) {
+        double dW = (W[1] - W[0]) / (2 * step);
+        double dWair = (Wair[1] - Wair[0]) / (2 * step);
+        dZ = -Z / 2 * (dW / energy + dWair / airEnergy);
+        return true;
+    };
+    // central differences of warm started solutions for the dimensions, the nominal point first. Started before
+    // the other sensitivities are reported, the sweep clears the messages
+    QStringList dimensionWarnings;
+    sensitivityDimensions.clear();
+    if(scenario) {
+        auto names = scenario->getParameterNames();
+        auto units = scenario->getParameterUnits();
+        auto values = scenario->getParameterValues();
+        QVector<QVector<double>> points = {values};
+        for(int i=0;i<values.size();i++) {
+            if(units[i] != "m") {
                 continue;
             }
-            // check for overlap
-            if(QPolygonF(e1->getVertices()).intersects(QPolygonF(e2->getVertices()))) {
-                error("Short circuit between RF \""+e2->getName()+"\" and GND \""+e1->getName()+"\"");
-                calculationStopped();
-                return;
+            // The faces along the grid lines end at the last grid line they cross, the impedance changes in steps
+            // within each cell. Whole cells keep that the same for all points, smaller steps are mostly the
+            // discretization error
+            double cell = std::max(ui->resolution->value(), ui->resolutionY->value());
+            double step = ceil(std::max(std::abs(values[i]) * 2e-2, cell) / cell) * cell;
+            if(step > std::abs(values[i]) / 2) {
+                // the dimensions have to stay positive
+                dimensionWarnings.append("\""+names[i]+"\" spans less than two cells of the grid, its sensitivity is not evaluated");
+                continue;
             }
+            for(auto sign : {-1.0, 1.0}) {
+                auto p = values;
+                p[i] += sign * step;
+                points.append(p);
+            }
+            sensitivityDimensions.append({names[i], units[i], values[i], step});
         }
-    }
-    // check for overlapping/touching RF elements
-    for(unsigned int i=0;i<list->getElements().size();i++) {
-        auto e1 = list->getElements()[i];
-        if(e1->getType() != Element::Type::TracePos && e1->getType() != Element::Type::TraceNeg) {
-            continue;
+        if(sensitivityDimensions.size() && ui->abort->isEnabled()) {
+            dimensionWarnings.append("A calculation is running, the sensitivities to the dimensions are not evaluated");
+            sensitivityDimensions.clear();
+        } else if(sensitivityDimensions.size()) {
+            sensitivityImpedance = hasP && hasN ? GoalSeek::Impedance::Differential : GoalSeek::Impedance::SingleEnded;
+            startSweep(sensitivitySweep, points, "Failed to start the calculation of the sensitivities to the dimensions");
         }
-        for(unsigned int j=i+1;j<list->getElements().size();j++) {
-            auto e2 = list->getElements()[j];
-            if(e2->getType() != Element::Type::TracePos && e2->getType() != Element::Type::TraceNeg) {
+    }
+
+    info("Sensitivities of the "+QString(hasP && hasN ? "differential " : "")+"impedance ("+Unit::ToString(Z, "Ω", " ", 4)+"):");
+    for(auto &w : dimensionWarnings) {
+        warning(w);
+    }
+    if(scenario) {
+        auto names = scenario->getParameterNames();
+        auto units = scenario->getParameterUnits();
+        auto values = scenario->getParameterValues();
+        for(int i=0;i<values.size();i++) {
+            if(units[i] == "m") {
+                // solved again, reported when the sweep is done
                 continue;
             }
-            // check for overlap
-            if(QPolygonF(e1->getVertices()).intersects(QPolygonF(e2->getVertices()))) {
-                error("Traces \""+e2->getName()+"\" and \""+e1->getName()+"\" touch/overlap, this is not supported");
-                calculationStopped();
-                return;
+            double step = std::max(std::abs(values[i]) * 1e-3, 1e-9);
+            double dZ;
+            bool success = derivative([&](double v) {
+                auto p = values;
+                p[i] = v;
+                scenario->setParameterValues(p);
+                auto topLeft = ui->view->getTopLeft();
+                auto bottomRight = ui->view->getBottomRight();
+                return scenario->create(topLeft, bottomRight, false);
+            }, values[i], step, dZ);
+            if(success) {
+                reportSensitivity(names[i], units[i], values[i], Z, dZ);
+            } else {
+                warning("Failed to evaluate the sensitivity to \""+names[i]+"\"");
             }
         }
+        scenario->setParameterValues(values);
     }
-    // check and warn about overlapping dielectrics
-    for(unsigned int i=0;i<list->getElements().size();i++) {
-        auto e1 = list->getElements()[i];
-        if(e1->getType() != Element::Type::Dielectric) {
+    auto json = list->toJSON();
+    for(int k=0;k<list->getElements().size();k++) {
+        auto e = list->getElements()[k];
+        if(e->getType() != Element::Type::Dielectric) {
             continue;
         }
-        for(unsigned int j=i+1;j<list->getElements().size();j++) {
-            auto e2 = list->getElements()[j];
-            if(e2->getType() != Element::Type::Dielectric) {
-                continue;
-            }
-            // check for overlap
-            auto P1 = QPolygonF(e1->getVertices());
-            auto P2 = QPolygonF(e2->getVertices());
-            if(P1.intersects(P2)) {
-                // check if this is actually an overlap or just touching
-                auto intersect = P1.intersected(P2);
-                // calculate area of intersection
-                double area = 0;
-                for(unsigned int k=0;k<intersect.size()-1;k++) {
-                    auto s1 = intersect[k];
-                    auto s2 = intersect[(k+1) % intersect.size()];
-                    area += s1.x() * s2.y() - s2.x() * s1.y();
-                }
-                area = abs(area / 2);
-                if(area > 0) {
-                    warning("Dielectric \""+e1->getName()+"\" and \""+e2->getName()+"\" overlap, \""+e1->getName()+"\" will be used for overlapping area");
+        double dZ;
+        bool success = derivative([&](double er) {
+            auto l = new ElementList();
+            l->fromJSON(json);
+            l->getElements()[k]->setEpsilonR(er);
+            return l;
+        }, e->getEpsilonR(), e->getEpsilonR() * 1e-3, dZ);
+        if(success) {
+            reportSensitivity("εr of \""+e->getName()+"\"", "", e->getEpsilonR(), Z, dZ);
+        } else {
+            warning("Failed to evaluate the sensitivity to εr of \""+e->getName()+"\"");
+        }
+    }
+}
+
+void MainWindow::reportSensitivity(QString name, QString unit, double value, double Z, double dZ)
+{
+    QString line = "    "+name+": ";
+    line += QString::number(dZ, 'g', 4)+" Ω"+(unit.isEmpty() ? "" : "/"+unit);
+    if(value != 0) {
+        // relative change of the impedance per relative change of the parameter
+        line += " ("+QString::number(dZ * value / Z, 'g', 3)+"% per +1%)";
+    }
+    info(line);
+}
+
+void MainWindow::sweepParameters()
+{
+    if(!scenario) {
+        InformationBox::ShowError("Error", "The sweep varies the parameters of a predefined scenario, create the elements from one first");
+        return;
+    }
+    if(ui->abort->isEnabled()) {
+        InformationBox::ShowError("Error", "A calculation is running, wait for it to finish");
+        return;
+    }
+    auto names = scenario->getParameterNames();
+    auto units = scenario->getParameterUnits();
+    auto nominal = scenario->getParameterValues();
+
+    auto d = new QDialog(this);
+    d->setAttribute(Qt::WA_DeleteOnClose);
+    auto dialog = new Ui::SweepDialog;
+    dialog->setupUi(d);
+    connect(d, &QDialog::destroyed, [=](){
+        delete dialog;
+    });
+
+    // one row per parameter, a single point keeps it at the start value
+    QVector<SIUnitEdit*> starts, stops;
+    QVector<QSpinBox*> counts;
+    dialog->parameters->setRowCount(names.size());
+    for(int i=0;i<names.size();i++) {
+        auto name = new QTableWidgetItem(names[i]);
+        name->setFlags(name->flags() & ~Qt::ItemIsEditable);
+        dialog->parameters->setItem(i, 0, name);
+        QString prefixes = units[i] == "m" ? "um " : " ";
+        starts.append(new SIUnitEdit(units[i], prefixes, 4));
+        starts.back()->setValue(nominal[i]);
+        dialog->parameters->setCellWidget(i, 1, starts.back());
+        stops.append(new SIUnitEdit(units[i], prefixes, 4));
+        stops.back()->setValue(nominal[i]);
+        dialog->parameters->setCellWidget(i, 2, stops.back());
+        counts.append(new QSpinBox());
+        counts.back()->setRange(1, 1000);
+        counts.back()->setValue(1);
+        dialog->parameters->setCellWidget(i, 3, counts.back());
+    }
+    auto total = [=]() -> int {
+        int points = 1;
+        for(auto c : counts) {
+            points *= c->value();
+        }
+        return points;
+    };
+    for(auto c : counts) {
+        connect(c, &QSpinBox::valueChanged, d, [=](){
+            dialog->total->setText(QString::number(total())+" points");
+        });
+    }
+    dialog->parameters->resizeColumnsToContents();
+
+    connect(dialog->buttonBox, &QDialogButtonBox::rejected, d, &QDialog::reject);
+    connect(dialog->buttonBox, &QDialogButtonBox::accepted, this, [=](){
+        if(total() < 2) {
+            InformationBox::ShowError("Error", "Set more than one point for at least one parameter");
+            return;
+        }
+        auto filename = QFileDialog::getSaveFileName(nullptr, "Save sweep table", "", "CSV files (*.csv)", nullptr, QFileDialog::DontUseNativeDialog);
+        if(filename.isEmpty()) {
+            // aborted selection
+            return;
+        }
+        if(!filename.endsWith(".csv")) {
+            filename.append(".csv");
+        }
+        sweepFilename = filename;
+
+        // all combinations of the parameter values, the last parameter changes fastest (neighbours are solved after each other)
+        QVector<QVector<double>> combinations(1);
+        for(int i=0;i<names.size();i++) {
+            int n = counts[i]->value();
+            QVector<QVector<double>> extended;
+            for(auto &c : combinations) {
+                for(int k=0;k<n;k++) {
+                    auto p = c;
+                    p.append(n > 1 ? starts[i]->value() + (stops[i]->value() - starts[i]->value()) * k / (n - 1) : starts[i]->value());
+                    extended.append(p);
                 }
             }
+            combinations = extended;
         }
+
+        startSweep(sweep, combinations, "Failed to start the sweep");
+        d->accept();
+    });
+
+    d->show();
+}
+
+void MainWindow::seekImpedance()
+{
+    if(!scenario) {
+        InformationBox::ShowError("Error", "The goal seek varies a parameter of a predefined scenario, create the elements from one first");
+        return;
     }
+    if(ui->abort->isEnabled()) {
+        InformationBox::ShowError("Error", "A calculation is running, wait for it to finish");
+        return;
+    }
+    auto names = scenario->getParameterNames();
+    auto units = scenario->getParameterUnits();
+    auto nominal = scenario->getParameterValues();
 
-    connect(&laplace, &Laplace::percentage, this, [=](int percent){
-        constexpr int minPercent = 0;
-        constexpr int maxPercent = 99;
-        ui->progress->setValue(percent * (maxPercent-minPercent) / 100 + minPercent);
+    auto d = new QDialog(this);
+    d->setAttribute(Qt::WA_DeleteOnClose);
+    auto dialog = new Ui::GoalSeekDialog;
+    dialog->setupUi(d);
+    connect(d, &QDialog::destroyed, [=](){
+        delete dialog;
     });
-    connect(ui->abort, &QPushButton::clicked, &laplace, &Laplace::abortCalculation);
 
-    // Start the dielectric laplace calculation
-    laplace.setArea(ui->view->getTopLeft(), ui->view->getBottomRight());
-    laplace.setGrid(ui->resolution->value());
-    laplace.setThreads(ui->threads->value());
-    laplace.setThreshold(ui->tolerance->value());
-    laplace.setGroundedBorders(ui->borderIsGND->isChecked());
-    laplace.startCalculation(list);
-    ui->view->update();
+    for(unsigned int i=0;i<(int) GoalSeek::Impedance::Last;i++) {
+        dialog->impedance->addItem(GoalSeek::ImpedanceToString((GoalSeek::Impedance) i));
+    }
+    bool hasP = false, hasN = false;
+    for(auto e : list->getElements()) {
+        hasP |= e->getType() == Element::Type::TracePos;
+        hasN |= e->getType() == Element::Type::TraceNeg;
+    }
+    bool differential = hasP && hasN;
+    dialog->impedance->setCurrentIndex((int) (differential ? GoalSeek::Impedance::Differential : GoalSeek::Impedance::SingleEnded));
+    dialog->target->setUnit("Ω");
+    dialog->target->setPrecision(4);
+    dialog->target->setValue(differential ? 100 : 50);
+    dialog->tolerance->setUnit("Ω");
+    dialog->tolerance->setPrecision(4);
+    dialog->tolerance->setValue(0.1);
+    dialog->parameter->addItems(names);
+    // the range follows the selected parameter
+    auto updateRange = [=](){
+        int i = dialog->parameter->currentIndex();
+        if(i < 0) {
+            return;
+        }
+        QString prefixes = units[i] == "m" ? "um " : " ";
+        for(auto e : {dialog->minimum, dialog->maximum}) {
+            e->setUnit(units[i]);
+            e->setPrefixes(prefixes);
+            e->setPrecision(4);
+        }
+        dialog->minimum->setValue(nominal[i] / 2);
+        dialog->maximum->setValue(nominal[i] * 2);
+    };
+    connect(dialog->parameter, &QComboBox::currentIndexChanged, d, updateRange);
+    updateRange();
+
+    connect(dialog->buttonBox, &QDialogButtonBox::rejected, d, &QDialog::reject);
+    connect(dialog->buttonBox, &QDialogButtonBox::accepted, this, [=](){
+        int p = dialog->parameter->currentIndex();
+        double min = dialog->minimum->value();
+        double max = dialog->maximum->value();
+        if(p < 0 || min >= max) {
+            InformationBox::ShowError("Error", "The minimum of the parameter must be below its maximum");
+            return;
+        }
+        goalSeekNominal = nominal;
+        goalSeekParameter = p;
+
+        // all values share the area (the warm start needs the same positions), large enough for both ends of the range
+        auto topLeft = ui->view->getTopLeft();
+        auto bottomRight = ui->view->getBottomRight();
+        auto ends = QVector<QVector<double>>(2, nominal);
+        ends[0][p] = min;
+        ends[1][p] = max;
+        scenario->growArea(ends, topLeft, bottomRight);
+
+        auto s = scenario;
+        goalSeek.setElements([=](double value) -> ElementList* {
+            auto values = nominal;
+            values[p] = value;
+            s->setParameterValues(values);
+            auto tl = topLeft;
+            auto br = bottomRight;
+            return s->create(tl, br, false);
+        });
+        goalSeek.setConfiguration(solverConfiguration());
+        goalSeek.setArea(topLeft, bottomRight);
+        goalSeek.setGrid(ui->resolution->value(), ui->resolutionY->value());
+        goalSeek.setThreads(ui->threads->value());
+        goalSeek.setParameter(names[p], units[p], min, max);
+        goalSeek.setTarget((GoalSeek::Impedance) dialog->impedance->currentIndex(), dialog->target->value(), dialog->tolerance->value());
+
+        ui->status->clear();
+        ui->update->setEnabled(false);
+        ui->abort->setEnabled(true);
+        ui->menuAnalysis->setEnabled(false);
+        connect(ui->abort, &QPushButton::clicked, &goalSeek, &GoalSeek::abort);
+        if(!goalSeek.start()) {
+            error("Failed to start the goal seek");
+            analysisStopped(&goalSeek);
+        }
+        d->accept();
+    });
+
+    d->show();
+}
+
+void MainWindow::analyzeTolerances()
+{
+    if(!scenario) {
+        InformationBox::ShowError("Error", "The Monte Carlo analysis varies the parameters of a predefined scenario, create the elements from one first");
+        return;
+    }
+    if(ui->abort->isEnabled()) {
+        InformationBox::ShowError("Error", "A calculation is running, wait for it to finish");
+        return;
+    }
+    auto names = scenario->getParameterNames();
+    auto units = scenario->getParameterUnits();
+    auto nominal = scenario->getParameterValues();
+
+    auto d = new QDialog(this);
+    d->setAttribute(Qt::WA_DeleteOnClose);
+    auto dialog = new Ui::MonteCarloDialog;
+    dialog->setupUi(d);
+    connect(d, &QDialog::destroyed, [=](){
+        delete dialog;
+    });
+
+    // one row per parameter, all of them vary by 5% by default
+    QVector<QComboBox*> distributions;
+    QVector<SIUnitEdit*> tolerances;
+    dialog->parameters->setRowCount(names.size());
+    for(int i=0;i<names.size();i++) {
+        auto name = new QTableWidgetItem(names[i]);
+        name->setFlags(name->flags() & ~Qt::ItemIsEditable);
+        dialog->parameters->setItem(i, 0, name);
+        QString prefixes = units[i] == "m" ? "um " : " ";
+        auto value = new QTableWidgetItem(Unit::ToString(nominal[i], units[i], prefixes, 4));
+        value->setFlags(value->flags() & ~Qt::ItemIsEditable);
+        dialog->parameters->setItem(i, 1, value);
+        distributions.append(new QComboBox());
+        for(unsigned int j=0;j<(int) MonteCarlo::Distribution::Last;j++) {
+            distributions.back()->addItem(MonteCarlo::DistributionToString((MonteCarlo::Distribution) j));
+        }
+        distributions.back()->setCurrentIndex((int) MonteCarlo::Distribution::Normal);
+        dialog->parameters->setCellWidget(i, 2, distributions.back());
+        tolerances.append(new SIUnitEdit(units[i], prefixes, 4));
+        tolerances.back()->setValue(std::abs(nominal[i]) * 0.05);
+        dialog->parameters->setCellWidget(i, 3, tolerances.back());
+    }
+    dialog->parameters->resizeColumnsToContents();
+
+    for(unsigned int i=0;i<(int) GoalSeek::Impedance::Last;i++) {
+        dialog->impedance->addItem(GoalSeek::ImpedanceToString((GoalSeek::Impedance) i));
+    }
+    bool hasP = false, hasN = false;
+    for(auto e : list->getElements()) {
+        hasP |= e->getType() == Element::Type::TracePos;
+        hasN |= e->getType() == Element::Type::TraceNeg;
+    }
+    dialog->impedance->setCurrentIndex((int) (hasP && hasN ? GoalSeek::Impedance::Differential : GoalSeek::Impedance::SingleEnded));
+
+    connect(dialog->buttonBox, &QDialogButtonBox::rejected, d, &QDialog::reject);
+    connect(dialog->buttonBox, &QDialogButtonBox::accepted, this, [=](){
+        monteCarlo.setNominal(nominal);
+        for(int i=0;i<names.size();i++) {
+            auto distribution = (MonteCarlo::Distribution) distributions[i]->currentIndex();
+            double tolerance = tolerances[i]->value();
+            if(distribution != MonteCarlo::Distribution::Fixed && nominal[i] > 0 && tolerance >= nominal[i]) {
+                // widths, heights and the dielectric constant have to stay positive
+                InformationBox::ShowError("Error", "The tolerance of \""+names[i]+"\" must be smaller than its nominal value");
+                return;
+            }
+            monteCarlo.setVariation(i, distribution, tolerance);
+        }
+        monteCarloImpedance = (GoalSeek::Impedance) dialog->impedance->currentIndex();
+
+        // the nominal point first, all samples start from its field (or from a closer sample that is already solved)
+        QVector<QVector<double>> samples = {nominal};
+        for(int i=0;i<dialog->samples->value();i++) {
+            samples.append(monteCarlo.sample());
+        }
+        startSweep(monteCarloSweep, samples, "Failed to start the Monte Carlo analysis");
+        d->accept();
+    });
+
+    d->show();
+}
+
+void MainWindow::buildSurrogate()
+{
+    if(!scenario) {
+        InformationBox::ShowError("Error", "The surrogate table is built for a predefined scenario, create the elements from one first");
+        return;
+    }
+    if(ui->abort->isEnabled()) {
+        InformationBox::ShowError("Error", "A calculation is running, wait for it to finish");
+        return;
+    }
+    auto names = scenario->getParameterNames();
+    auto units = scenario->getParameterUnits();
+    auto nominal = scenario->getParameterValues();
+
+    auto d = new QDialog(this);
+    d->setAttribute(Qt::WA_DeleteOnClose);
+    auto dialog = new Ui::SweepDialog;
+    dialog->setupUi(d);
+    d->setWindowTitle("Surrogate Table of "+scenario->getName());
+    connect(d, &QDialog::destroyed, [=](){
+        delete dialog;
+    });
+
+    // one row per parameter, a single point keeps it at the start value (only that value is predicted)
+    QVector<SIUnitEdit*> starts, stops;
+    QVector<QSpinBox*> counts;
+    dialog->parameters->setRowCount(names.size());
+    for(int i=0;i<names.size();i++) {
+        auto name = new QTableWidgetItem(names[i]);
+        name->setFlags(name->flags() & ~Qt::ItemIsEditable);
+        dialog->parameters->setItem(i, 0, name);
+        QString prefixes = units[i] == "m" ? "um " : " ";
+        starts.append(new SIUnitEdit(units[i], prefixes, 4));
+        starts.back()->setValue(nominal[i]);
+        dialog->parameters->setCellWidget(i, 1, starts.back());
+        stops.append(new SIUnitEdit(units[i], prefixes, 4));
+        stops.back()->setValue(nominal[i]);
+        dialog->parameters->setCellWidget(i, 2, stops.back());
+        counts.append(new QSpinBox());
+        counts.back()->setRange(1, 100);
+        counts.back()->setValue(1);
+        dialog->parameters->setCellWidget(i, 3, counts.back());
+    }
+    auto total = [=]() -> int {
+        int points = 1;
+        for(auto c : counts) {
+            points *= c->value();
+        }
+        return points;
+    };
+    for(auto c : counts) {
+        connect(c, &QSpinBox::valueChanged, d, [=](){
+            dialog->total->setText(QString::number(total())+" nodes");
+        });
+    }
+    dialog->total->setText("1 node");
+    dialog->parameters->resizeColumnsToContents();
+
+    connect(dialog->buttonBox, &QDialogButtonBox::rejected, d, &QDialog::reject);
+    connect(dialog->buttonBox, &QDialogButtonBox::accepted, this, [=](){
+        if(total() < 2) {
+            InformationBox::ShowError("Error", "Set more than one point for at least one parameter");
+            return;
+        }
+        QVector<QVector<double>> axes;
+        for(int i=0;i<names.size();i++) {
+            int n = counts[i]->value();
+            QVector<double> axis;
+            for(int k=0;k<n;k++) {
+                axis.append(n > 1 ? starts[i]->value() + (stops[i]->value() - starts[i]->value()) * k / (n - 1) : starts[i]->value());
+            }
+            axes.append(axis);
+        }
+        surrogateTable.setGrid(scenario->getName(), names, axes);
+        surrogateTable.setSettings(surrogateSettings());
+        surrogateScenario = scenario;
+
+        QVector<QVector<double>> nodes;
+        for(int i=0;i<surrogateTable.getNodes();i++) {
+            nodes.append(surrogateTable.getNode(i));
+        }
+        startSweep(surrogateSweep, nodes, "Failed to start building the surrogate table");
+        d->accept();
+    });
+
+    d->show();
+}
+
+void MainWindow::connectSweep(Sweep &s)
+{
+    connect(&s, &Sweep::info, this, &MainWindow::info);
+    connect(&s, &Sweep::warning, this, &MainWindow::warning);
+    connect(&s, &Sweep::error, this, &MainWindow::error);
+    connect(&s, &Sweep::percentage, ui->progress, &QProgressBar::setValue);
+    connect(&s, &Sweep::sweepAborted, this, [=, &s](){
+        analysisStopped(&s);
+    });
+}
+
+void MainWindow::startSweep(Sweep &s, const QVector<QVector<double>> &parameterSets, QString failure)
+{
+    // all points share the area (the warm start needs the same positions), large enough for each of them
+    auto topLeft = ui->view->getTopLeft();
+    auto bottomRight = ui->view->getBottomRight();
+    auto lists = scenario->create(parameterSets, topLeft, bottomRight);
+    s.clear();
+    for(int i=0;i<parameterSets.size();i++) {
+        s.addPoint(parameterSets[i], lists[i]);
+    }
+    s.setConfiguration(solverConfiguration());
+    s.setArea(topLeft, bottomRight);
+    s.setThreads(ui->threads->value());
+    s.setParameterNames(scenario->getParameterNames(), scenario->getParameterUnits());
+
+    ui->status->clear();
+    ui->progress->setValue(0);
+    ui->update->setEnabled(false);
+    ui->abort->setEnabled(true);
+    ui->menuAnalysis->setEnabled(false);
+    connect(ui->abort, &QPushButton::clicked, &s, &Sweep::abort);
+    if(!s.start()) {
+        error(failure);
+        analysisStopped(&s);
+    }
+}
+
+void MainWindow::analysisStopped(QObject *analysis)
+{
+    disconnect(ui->abort, nullptr, analysis, nullptr);
+    ui->update->setEnabled(true);
+    ui->abort->setEnabled(false);
+    ui->menuAnalysis->setEnabled(true);
+}
+
+std::function<void(Laplace*)> MainWindow::solverConfiguration()
+{
+    // copies of the settings, the calculations may run in other threads
+    double gridX = ui->resolution->value();
+    double gridY = ui->resolutionY->value();
+    double threshold = ui->tolerance->value();
+    bool groundedBorders = ui->borderIsGND->isChecked();
+    auto averaging = (Laplace::DielectricAveraging) ui->dielectricAveraging->currentIndex();
+    bool subCellBoundaries = ui->subCellBoundaries->isChecked();
+    auto method = (Laplace::Method) ui->method->currentIndex();
+    auto acceleration = (Laplace::Acceleration) ui->acceleration->currentIndex();
+    int andersonWindow = ui->andersonWindow->value();
+    auto chargeExtraction = (Laplace::ChargeExtraction) ui->chargeExtraction->currentIndex();
+    return [=](Laplace *l) {
+        l->setGrid(gridX, gridY);
+        l->setThreshold(threshold);
+        l->setGroundedBorders(groundedBorders);
+        l->setDielectricAveraging(averaging);
+        l->setSubCellBoundaries(subCellBoundaries);
+        l->setMethod(method);
+        l->setAcceleration(acceleration);
+        l->setAndersonWindow(andersonWindow);
+        l->setChargeExtraction(chargeExtraction);
+    };
+}
+
+Surrogate::Settings MainWindow::surrogateSettings()
+{
+    Surrogate::Settings s;
+    s.gridX = ui->resolution->value();
+    s.gridY = ui->resolutionY->value();
+    s.tolerance = ui->tolerance->value();
+    s.averaging = (Laplace::DielectricAveraging) ui->dielectricAveraging->currentIndex();
+    s.subCellBoundaries = ui->subCellBoundaries->isChecked();
+    s.groundedBorders = ui->borderIsGND->isChecked();
+    // the sweep grows it for the nodes, starting from the area of the view
+    s.topLeft = ui->view->getTopLeft();
+    s.bottomRight = ui->view->getBottomRight();
+    return s;
 }
 
 void MainWindow::calculationStopped()
@@ -517,10 +1329,20 @@ void MainWindow::calculationStopped()
     ui->ytop->setEnabled(true);
     ui->ybottom->setEnabled(true);
     ui->resolution->setEnabled(true);
-    ui->gaussDistance->setEnabled(true);
+    ui->resolutionY->setEnabled(true);
     ui->threads->setEnabled(true);
     ui->tolerance->setEnabled(true);
     ui->borderIsGND->setEnabled(true);
+    ui->dielectricAveraging->setEnabled(true);
+    ui->subCellBoundaries->setEnabled(true);
+    ui->method->setEnabled(true);
+    ui->acceleration->setEnabled(ui->method->currentIndex() == (int) Laplace::Method::Zebra);
+    ui->andersonWindow->setEnabled(ui->method->currentIndex() == (int) Laplace::Method::Zebra);
+    ui->chargeConvergence->setEnabled(true);
+    ui->chargeTolerance->setEnabled(true);
+    ui->timeBudget->setEnabled(true);
+    ui->chargeExtraction->setEnabled(true);
+    ui->conductorMatrix->setEnabled(true);
     ui->add->setEnabled(true);
     ui->remove->setEnabled(true);
 }
@@ -7,6 +7,13 @@
 #include "laplace/laplace.h"
 #include "gauss/gauss.h"
 #include "savable.h"
+#include "Scenarios/scenario.h"
+#include "sweep.h"
+#include "goalseek.h"
+#include "montecarlo.h"
+#include "surrogate.h"
+
+#include <functional>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -32,9 +39,59 @@ private:
     static constexpr double e0 = 8.8541878188e-12;
     void startCalculation();
     void calculationStopped();
+    // derivatives of the impedance with respect to the scenario parameters and all dielectric constants. The
+    // dimensions are solved again in the background, their derivatives are reported when that is done
+    void computeSensitivities();
+    void reportSensitivity(QString name, QString unit, double value, double Z, double dZ);
+    // solves the current scenario for ranges of its parameters and writes the table of C/L/Z
+    void sweepParameters();
+    // searches the value of a scenario parameter that results in a target impedance
+    void seekImpedance();
+    // solves random variations of the scenario parameters and reports the distribution of the impedance
+    void analyzeTolerances();
+    // solves the current scenario on a grid of its parameters, the scenario dialog predicts the impedance from it
+    void buildSurrogate();
+    // forwards the messages and the progress of a sweep, the window is enabled again if it is aborted
+    void connectSweep(Sweep &s);
+    // solves the current scenario for all parameter sets on one area, reports the failure if it can not be started
+    void startSweep(Sweep &s, const QVector<QVector<double>> &parameterSets, QString failure);
+    // enables the window again after a sweep or goal seek
+    void analysisStopped(QObject *analysis);
+    // applies the solver settings (except the area, threads and what is calculated), usable from other threads
+    std::function<void(Laplace*)> solverConfiguration();
+    // the settings that the predictions of a surrogate table are only valid for
+    Surrogate::Settings surrogateSettings();
     Ui::MainWindow *ui;
     ElementList *list;
     Laplace laplace;
     Gauss gauss;
+    Sweep sweep;
+    QString sweepFilename;
+    GoalSeek goalSeek;
+    // the parameter values of the scenario before the goal seek
+    QVector<double> goalSeekNominal;
+    int goalSeekParameter;
+    // the first point of the Monte Carlo sweep is the nominal one
+    Sweep monteCarloSweep;
+    MonteCarlo monteCarlo;
+    GoalSeek::Impedance monteCarloImpedance;
+    // the first point is the nominal one, followed by the lower and upper value of each dimension
+    Sweep sensitivitySweep;
+    GoalSeek::Impedance sensitivityImpedance;
+    class Dimension {
+    public:
+        QString name, unit;
+        double value, step;
+    };
+    QVector<Dimension> sensitivityDimensions;
+    Sweep surrogateSweep;
+    Surrogate surrogateTable;
+    Scenario *surrogateScenario;
+    // the predefined scenario the elements were created from, nullptr if they were loaded
+    Scenario *scenario;
+    // the air field is solved separately for the conductor residual, its charges are kept for the dielectric run
+    bool separateAirCalculation;
+    bool airCalculation;
+    double airChargeP, airChargeN;
 };
 #endif // MAINWINDOW_H
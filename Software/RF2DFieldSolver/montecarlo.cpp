@@ -0,0 +1,116 @@
+#include "montecarlo.h"
+
+#include <algorithm>
+#include <cmath>
+
+MonteCarlo::MonteCarlo()
+{
+    generator.seed(std::random_device()());
+}
+
+QString MonteCarlo::DistributionToString(Distribution d)
+{
+    switch(d) {
+    case Distribution::Fixed: return "Fixed";
+    case Distribution::Uniform: return "Uniform";
+    case Distribution::Normal: return "Normal";
+    case Distribution::Last: return "Invalid";
+    }
+    return "Invalid";
+}
+
+MonteCarlo::Distribution MonteCarlo::DistributionFromString(QString s)
+{
+    for(unsigned int i=0;i<(int) Distribution::Last;i++) {
+        if(s == DistributionToString((Distribution) i)) {
+            return (Distribution) i;
+        }
+    }
+    return Distribution::Last;
+}
+
+void MonteCarlo::setNominal(const QVector<double> &nominal)
+{
+    this->nominal = nominal;
+    variations.resize(nominal.size(), {Distribution::Fixed, 0});
+}
+
+void MonteCarlo::setVariation(int parameter, Distribution distribution, double tolerance)
+{
+    if(parameter < 0 || parameter >= (int) variations.size()) {
+        return;
+    }
+    variations[parameter] = {distribution, std::abs(tolerance)};
+}
+
+void MonteCarlo::setSeed(unsigned int seed)
+{
+    generator.seed(seed);
+}
+
+QVector<double> MonteCarlo::sample()
+{
+    auto values = nominal;
+    for(int i=0;i<values.size();i++) {
+        auto &v = variations[i];
+        if(v.tolerance == 0) {
+            continue;
+        }
+        switch(v.distribution) {
+        case Distribution::Fixed:
+        case Distribution::Last:
+            break;
+        case Distribution::Uniform:
+            values[i] += std::uniform_real_distribution<double>(-v.tolerance, v.tolerance)(generator);
+            break;
+        case Distribution::Normal: {
+            std::normal_distribution<double> normal(0, v.tolerance / 3);
+            double deviation;
+            // outside of the tolerance only in 0.3% of the draws
+            do {
+                deviation = normal(generator);
+            } while(std::abs(deviation) > v.tolerance);
+            values[i] += deviation;
+        }
+            break;
+        }
+    }
+    return values;
+}
+
+MonteCarlo::Statistics MonteCarlo::evaluate(std::vector<double> values, const std::vector<double> &percentiles)
+{
+    values.erase(std::remove_if(values.begin(), values.end(), [](double v){return std::isnan(v);}), values.end());
+    Statistics s;
+    auto nan = std::numeric_limits<double>::quiet_NaN();
+    s.samples = values.size();
+    if(values.empty()) {
+        s.mean = s.deviation = s.min = s.max = nan;
+        for(auto p : percentiles) {
+            s.percentiles.push_back({p, nan});
+        }
+        return s;
+    }
+    std::sort(values.begin(), values.end());
+    s.min = values.front();
+    s.max = values.back();
+    double sum = 0;
+    for(auto v : values) {
+        sum += v;
+    }
+    s.mean = sum / values.size();
+    double squares = 0;
+    for(auto v : values) {
+        squares += (v - s.mean) * (v - s.mean);
+    }
+    s.deviation = values.size() > 1 ? sqrt(squares / (values.size() - 1)) : 0;
+    for(auto p : percentiles) {
+        // linear interpolation between the closest ranks
+        double rank = std::clamp(p, 0.0, 100.0) / 100.0 * (values.size() - 1);
+        unsigned int below = floor(rank);
+        unsigned int above = std::min(below + 1, (unsigned int) values.size() - 1);
+        double value = values[below] + (rank - below) * (values[above] - values[below]);
+        s.percentiles.push_back({p, value});
+    }
+    return s;
+}
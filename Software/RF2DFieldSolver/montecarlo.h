@@ -0,0 +1,59 @@
+#ifndef MONTECARLO_H
+#define MONTECARLO_H
+
+#include <QString>
+#include <QVector>
+
+#include <random>
+#include <vector>
+
+// Random variations of a set of parameters around their nominal values (e.g. manufacturing tolerances of a
+// scenario) and the statistics of the results
+class MonteCarlo
+{
+public:
+    MonteCarlo();
+
+    enum class Distribution {
+        // always the nominal value
+        Fixed,
+        // equally distributed within nominal +/- tolerance
+        Uniform,
+        // normal distribution with the tolerance as 3 sigma, truncated at the tolerance
+        Normal,
+        Last,
+    };
+
+    static QString DistributionToString(Distribution d);
+    static Distribution DistributionFromString(QString s);
+
+    void setNominal(const QVector<double> &nominal);
+    void setVariation(int parameter, Distribution distribution, double tolerance);
+    void setSeed(unsigned int seed);
+    // a random set of parameters
+    QVector<double> sample();
+
+    class Statistics {
+    public:
+        int samples;
+        double mean;
+        double deviation;
+        double min, max;
+        // percentile (0 to 100) and value
+        std::vector<std::pair<double, double>> percentiles;
+    };
+    // statistics of the values, NaN values are ignored
+    static Statistics evaluate(std::vector<double> values, const std::vector<double> &percentiles = {1, 5, 25, 50, 75, 95, 99});
+
+private:
+    class Variation {
+    public:
+        Distribution distribution;
+        double tolerance;
+    };
+    QVector<double> nominal;
+    std::vector<Variation> variations;
+    std::mt19937 generator;
+};
+
+#endif // MONTECARLO_H
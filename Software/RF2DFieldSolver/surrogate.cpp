@@ -0,0 +1,305 @@
+#include "surrogate.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+
+Surrogate::Surrogate()
+{
+
+}
+
+void Surrogate::setGrid(QString scenario, const QStringList &names, const QVector<QVector<double>> &axes)
+{
+    this->scenario = scenario;
+    this->names = names;
+    this->axes = axes;
+    for(auto &a : this->axes) {
+        std::sort(a.begin(), a.end());
+    }
+    unsigned int count = axes.size() ? 1 : 0;
+    for(auto &a : axes) {
+        count *= a.size();
+    }
+    Values nan;
+    nan.fill(std::numeric_limits<double>::quiet_NaN());
+    nodes = std::vector<Values>(count, nan);
+}
+
+Surrogate::Settings::Settings()
+{
+    auto nan = std::numeric_limits<double>::quiet_NaN();
+    gridX = gridY = tolerance = nan;
+    averaging = Laplace::DielectricAveraging::Last;
+    subCellBoundaries = false;
+    groundedBorders = true;
+    topLeft = bottomRight = QPointF(nan, nan);
+}
+
+bool Surrogate::Settings::operator==(const Settings &s) const
+{
+    // the values went through the JSON file, allow for rounding
+    auto equal = [](double a, double b) -> bool {
+        return std::abs(a - b) <= 1e-9 * std::max(std::abs(a), std::abs(b));
+    };
+    return equal(gridX, s.gridX) && equal(gridY, s.gridY) && equal(tolerance, s.tolerance) && averaging == s.averaging
+            && subCellBoundaries == s.subCellBoundaries && groundedBorders == s.groundedBorders
+            && equal(topLeft.x(), s.topLeft.x()) && equal(topLeft.y(), s.topLeft.y())
+            && equal(bottomRight.x(), s.bottomRight.x()) && equal(bottomRight.y(), s.bottomRight.y());
+}
+
+QVector<double> Surrogate::getNode(int index) const
+{
+    QVector<double> node(axes.size());
+    for(int d=axes.size()-1;d>=0;d--) {
+        node[d] = axes[d][index % axes[d].size()];
+        index /= axes[d].size();
+    }
+    return node;
+}
+
+void Surrogate::setResult(int index, const Laplace::LineParameters &result)
+{
+    if(index < 0 || index >= (int) nodes.size()) {
+        return;
+    }
+    auto logarithm = [](double v) -> double {
+        return v > 0 ? log(v) : std::numeric_limits<double>::quiet_NaN();
+    };
+    auto &n = nodes[index];
+    n[(int) Column::LogCapacitanceP] = logarithm(result.capacitanceP);
+    n[(int) Column::LogInductanceP] = logarithm(result.inductanceP);
+    n[(int) Column::LogCapacitanceN] = logarithm(result.capacitanceN);
+    n[(int) Column::LogInductanceN] = logarithm(result.inductanceN);
+    n[(int) Column::ImpedanceDiff] = result.impedanceDiff;
+    n[(int) Column::ImpedanceComm] = result.modes.common;
+}
+
+bool Surrogate::predict(const QVector<double> &parameters, Prediction &prediction) const
+{
+    if(nodes.empty() || parameters.size() != axes.size()) {
+        return false;
+    }
+    std::vector<Stencil> stencils(axes.size());
+    for(int d=0;d<axes.size();d++) {
+        if(!stencil(axes[d], parameters[d], stencils[d])) {
+            return false;
+        }
+    }
+
+    // sum over all combinations of the stencil nodes
+    Values cubic, linear;
+    cubic.fill(0);
+    linear.fill(0);
+    std::vector<unsigned int> k(axes.size(), 0);
+    while(true) {
+        double wc = 1.0, wl = 1.0;
+        unsigned int index = 0;
+        for(int d=0;d<axes.size();d++) {
+            wc *= stencils[d].cubic[k[d]];
+            wl *= stencils[d].linear[k[d]];
+            index = index * axes[d].size() + stencils[d].first + k[d];
+        }
+        for(int c=0;c<(int) Column::Last;c++) {
+            cubic[c] += wc * nodes[index][c];
+            if(wl != 0) {
+                linear[c] += wl * nodes[index][c];
+            }
+        }
+        // next combination, the last axis changes fastest
+        int d = axes.size() - 1;
+        while(d >= 0 && ++k[d] >= stencils[d].cubic.size()) {
+            k[d] = 0;
+            d--;
+        }
+        if(d < 0) {
+            break;
+        }
+    }
+
+    prediction.parameters = toLineParameters(cubic);
+    auto lin = toLineParameters(linear);
+    auto &p = prediction.parameters;
+    prediction.error = 0;
+    for(auto z : {std::make_pair(p.impedanceP, lin.impedanceP), std::make_pair(p.impedanceN, lin.impedanceN),
+                  std::make_pair(p.impedanceDiff, lin.impedanceDiff), std::make_pair(p.modes.common, lin.modes.common)}) {
+        if(!std::isnan(z.first)) {
+            prediction.error = std::max(prediction.error, std::abs(z.first - z.second) / z.first);
+        }
+    }
+    return true;
+}
+
+nlohmann::json Surrogate::toJSON()
+{
+    nlohmann::json j;
+    j["scenario"] = scenario.toStdString();
+    nlohmann::json jparameters;
+    for(int i=0;i<axes.size();i++) {
+        nlohmann::json jparameter;
+        jparameter["name"] = names.value(i).toStdString();
+        jparameter["values"] = std::vector<double>(axes[i].begin(), axes[i].end());
+        jparameters.push_back(jparameter);
+    }
+    j["parameters"] = jparameters;
+    nlohmann::json jnodes;
+    for(auto &n : nodes) {
+        nlohmann::json jnode;
+        for(auto v : n) {
+            // not available values are stored as null
+            if(std::isnan(v)) {
+                jnode.push_back(nullptr);
+            } else {
+                jnode.push_back(v);
+            }
+        }
+        jnodes.push_back(jnode);
+    }
+    j["nodes"] = jnodes;
+    nlohmann::json jsettings;
+    jsettings["simulationGrid"] = settings.gridX;
+    jsettings["simulationGridY"] = settings.gridY;
+    jsettings["tolerance"] = settings.tolerance;
+    jsettings["dielectricAveraging"] = Laplace::DielectricAveragingToString(settings.averaging).toStdString();
+    jsettings["subCellBoundaries"] = settings.subCellBoundaries;
+    jsettings["borderIsGND"] = settings.groundedBorders;
+    jsettings["xleft"] = settings.topLeft.x();
+    jsettings["xright"] = settings.bottomRight.x();
+    jsettings["ytop"] = settings.topLeft.y();
+    jsettings["ybottom"] = settings.bottomRight.y();
+    j["settings"] = jsettings;
+    return j;
+}
+
+void Surrogate::fromJSON(nlohmann::json j)
+{
+    QStringList names;
+    QVector<QVector<double>> axes;
+    for(auto &jparameter : j.value("parameters", nlohmann::json::array())) {
+        names.append(QString::fromStdString(jparameter.value("name", "")));
+        auto values = jparameter.value("values", std::vector<double>());
+        axes.append(QVector<double>(values.begin(), values.end()));
+    }
+    setGrid(QString::fromStdString(j.value("scenario", "")), names, axes);
+    settings = Settings();
+    if(j.contains("settings")) {
+        auto &jsettings = j["settings"];
+        auto nan = std::numeric_limits<double>::quiet_NaN();
+        settings.gridX = jsettings.value("simulationGrid", nan);
+        settings.gridY = jsettings.value("simulationGridY", nan);
+        settings.tolerance = jsettings.value("tolerance", nan);
+        settings.averaging = Laplace::DielectricAveragingFromString(QString::fromStdString(jsettings.value("dielectricAveraging", "")));
+        settings.subCellBoundaries = jsettings.value("subCellBoundaries", false);
+        settings.groundedBorders = jsettings.value("borderIsGND", true);
+        settings.topLeft = QPointF(jsettings.value("xleft", nan), jsettings.value("ytop", nan));
+        settings.bottomRight = QPointF(jsettings.value("xright", nan), jsettings.value("ybottom", nan));
+    }
+    if(!j.contains("nodes") || j["nodes"].size() != nodes.size()) {
+        // incomplete table
+        nodes.clear();
+        return;
+    }
+    for(unsigned int i=0;i<nodes.size();i++) {
+        auto &jnode = j["nodes"][i];
+        for(unsigned int c=0;c<(int) Column::Last && c<jnode.size();c++) {
+            if(!jnode[c].is_null()) {
+                nodes[i][c] = jnode[c];
+            }
+        }
+    }
+}
+
+bool Surrogate::save(QString filename)
+{
+    QDir().mkpath(QFileInfo(filename).absolutePath());
+    std::ofstream file;
+    file.open(filename.toStdString());
+    if(!file.is_open()) {
+        return false;
+    }
+    file << std::setw(4) << toJSON() << std::endl;
+    file.close();
+    return true;
+}
+
+bool Surrogate::load(QString filename)
+{
+    std::ifstream file;
+    file.open(filename.toStdString());
+    if(!file.is_open()) {
+        return false;
+    }
+    nlohmann::json j;
+    try {
+        file >> j;
+        fromJSON(j);
+    } catch (std::exception &e) {
+        qWarning() << "Parsing of surrogate table failed: " << e.what();
+        nodes.clear();
+        return false;
+    }
+    return !nodes.empty();
+}
+
+QString Surrogate::tableFilename(QString scenario)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/surrogates/" + scenario + ".json";
+}
+
+bool Surrogate::stencil(const QVector<double> &axis, double x, Stencil &s)
+{
+    int n = axis.size();
+    if(n == 1) {
+        // not varied, has to match the table
+        s.first = 0;
+        s.cubic = {1.0};
+        s.linear = {1.0};
+        return std::abs(x - axis[0]) <= 1e-9 * std::max(std::abs(axis[0]), 1e-12);
+    }
+    double tolerance = 1e-9 * (axis.back() - axis.front());
+    if(x < axis.front() - tolerance || x > axis.back() + tolerance) {
+        return false;
+    }
+    int cell = std::upper_bound(axis.begin(), axis.end(), x) - axis.begin() - 1;
+    cell = std::clamp(cell, 0, n - 2);
+    int order = std::min(n, 4);
+    s.first = std::clamp(cell - 1, 0, n - order);
+    s.cubic.resize(order);
+    s.linear.assign(order, 0);
+    for(int i=0;i<order;i++) {
+        // lagrange polynomial of the node
+        double w = 1.0;
+        for(int j=0;j<order;j++) {
+            if(j != i) {
+                w *= (x - axis[s.first + j]) / (axis[s.first + i] - axis[s.first + j]);
+            }
+        }
+        s.cubic[i] = w;
+    }
+    double t = (x - axis[cell]) / (axis[cell + 1] - axis[cell]);
+    s.linear[cell - s.first] = 1.0 - t;
+    s.linear[cell + 1 - s.first] = t;
+    return true;
+}
+
+Laplace::LineParameters Surrogate::toLineParameters(const Values &v)
+{
+    Laplace::LineParameters p;
+    p.capacitanceP = exp(v[(int) Column::LogCapacitanceP]);
+    p.inductanceP = exp(v[(int) Column::LogInductanceP]);
+    p.capacitanceN = exp(v[(int) Column::LogCapacitanceN]);
+    p.inductanceN = exp(v[(int) Column::LogInductanceN]);
+    p.impedanceP = sqrt(p.inductanceP / p.capacitanceP);
+    p.impedanceN = sqrt(p.inductanceN / p.capacitanceN);
+    p.impedanceDiff = v[(int) Column::ImpedanceDiff];
+    p.modes.differential = v[(int) Column::ImpedanceDiff];
+    p.modes.common = v[(int) Column::ImpedanceComm];
+    p.modes.odd = p.modes.differential / 2;
+    p.modes.even = p.modes.common * 2;
+    return p;
+}
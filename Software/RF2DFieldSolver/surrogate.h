@@ -0,0 +1,92 @@
+#ifndef SURROGATE_H
+#define SURROGATE_H
+
+#include <QPointF>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <array>
+#include <vector>
+
+#include "savable.h"
+#include "laplace/laplace.h"
+
+// Table of the line parameters of a scenario on a regular grid of its parameters. Predicts the line parameters
+// within the grid by tensor product cubic interpolation, without a calculation. Parameters with a single value
+// in the table have to match it exactly. The predictions are only valid for the solver settings of the table
+class Surrogate : public Savable
+{
+public:
+    Surrogate();
+
+    // the values of each parameter in ascending order, a single value for parameters that are not varied
+    void setGrid(QString scenario, const QStringList &names, const QVector<QVector<double>> &axes);
+    QString getScenario() const {return scenario;}
+    bool isEmpty() const {return nodes.empty();}
+    int getNodes() const {return nodes.size();}
+    // the parameters of a node, the last parameter changes fastest
+    QVector<double> getNode(int index) const;
+    void setResult(int index, const Laplace::LineParameters &result);
+
+    // the solver settings that change the result and the area before it was grown for the nodes
+    class Settings {
+    public:
+        Settings();
+        bool operator==(const Settings &s) const;
+        bool operator!=(const Settings &s) const {return !(*this == s);}
+        double gridX, gridY;
+        double tolerance;
+        Laplace::DielectricAveraging averaging;
+        bool subCellBoundaries;
+        bool groundedBorders;
+        QPointF topLeft, bottomRight;
+    };
+    void setSettings(const Settings &settings) {this->settings = settings;}
+    // not known (never equal to other settings) for tables of older versions
+    const Settings &getSettings() const {return settings;}
+
+    class Prediction {
+    public:
+        Laplace::LineParameters parameters;
+        // estimated relative error of the impedances, difference to the linear interpolation
+        double error;
+    };
+    // false if the parameters are outside of the table
+    bool predict(const QVector<double> &parameters, Prediction &prediction) const;
+
+    virtual nlohmann::json toJSON() override;
+    virtual void fromJSON(nlohmann::json j) override;
+    bool save(QString filename);
+    bool load(QString filename);
+    // the table of a scenario in the application data directory
+    static QString tableFilename(QString scenario);
+
+private:
+    // interpolated quantities of each node, C and L logarithmic (they change over decades with the geometry)
+    enum class Column {
+        LogCapacitanceP,
+        LogInductanceP,
+        LogCapacitanceN,
+        LogInductanceN,
+        ImpedanceDiff,
+        ImpedanceComm,
+        Last,
+    };
+    using Values = std::array<double, (int) Column::Last>;
+    // weights of the nodes along one axis, cubic (or lower with less than four values) and linear
+    class Stencil {
+    public:
+        int first;
+        std::vector<double> cubic, linear;
+    };
+    static bool stencil(const QVector<double> &axis, double x, Stencil &s);
+    static Laplace::LineParameters toLineParameters(const Values &v);
+    QString scenario;
+    QStringList names;
+    QVector<QVector<double>> axes;
+    std::vector<Values> nodes;
+    Settings settings;
+};
+
+#endif // SURROGATE_H
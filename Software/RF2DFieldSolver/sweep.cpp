@@ -0,0 +1,331 @@
+#include "sweep.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+Sweep::Sweep(QObject *parent)
+    : QObject{parent}
+{
+    threads = 1;
+    threadsPerPoint = 1;
+    keptSolutions = 1;
+    nextPoint = 0;
+    running = false;
+    threaded = false;
+    abortRequested = false;
+}
+
+Sweep::~Sweep()
+{
+    if(running) {
+        abort();
+    }
+    if(threaded) {
+        pthread_join(thread, nullptr);
+    }
+    clear();
+}
+
+void Sweep::setConfiguration(std::function<void (Laplace *)> configure)
+{
+    if(running) {
+        return;
+    }
+    this->configure = configure;
+}
+
+void Sweep::setArea(const QPointF &topLeft, const QPointF &bottomRight)
+{
+    if(running) {
+        return;
+    }
+    this->topLeft = topLeft;
+    this->bottomRight = bottomRight;
+}
+
+void Sweep::setThreads(int threads)
+{
+    if(running) {
+        return;
+    }
+    this->threads = std::max(1, threads);
+}
+
+void Sweep::setParameterNames(const QStringList &names, const QStringList &units)
+{
+    if(running) {
+        return;
+    }
+    this->names = names;
+    this->units = units;
+}
+
+void Sweep::addPoint(const QVector<double> &parameters, ElementList *list)
+{
+    if(running) {
+        return;
+    }
+    auto nan = std::numeric_limits<double>::quiet_NaN();
+    points.push_back({parameters, list, false, {nan, nan, nan, nan, nan, nan, nan, {nan, nan, nan, nan}}, nullptr});
+}
+
+void Sweep::clear()
+{
+    if(running) {
+        return;
+    }
+    for(auto &p : points) {
+        while(p.list->getElements().size()) {
+            p.list->removeElement(0);
+        }
+        delete p.list;
+    }
+    points.clear();
+    solvedOrder.clear();
+}
+
+bool Sweep::start()
+{
+    if(!prepare()) {
+        return false;
+    }
+    threaded = true;
+    auto err = pthread_create(&thread, nullptr, executeTrampoline, this);
+    if(err) {
+        emit error("Failed to start sweep thread");
+        running = false;
+        threaded = false;
+        return false;
+    }
+    return true;
+}
+
+bool Sweep::run()
+{
+    if(!prepare()) {
+        return false;
+    }
+    threaded = false;
+    return execute();
+}
+
+void Sweep::abort()
+{
+    QMutexLocker locker(&mutex);
+    abortRequested = true;
+    for(auto l : active) {
+        l->abortCalculation();
+    }
+}
+
+Laplace::LineParameters Sweep::getResult(int point)
+{
+    QMutexLocker locker(&mutex);
+    return points[point].result;
+}
+
+bool Sweep::exportTable(QString filename)
+{
+    std::ofstream file;
+    file.open(filename.toStdString());
+    if(!file.is_open()) {
+        return false;
+    }
+    for(int i=0;i<names.size();i++) {
+        file << names[i].toStdString();
+        if(i < units.size() && !units[i].isEmpty()) {
+            file << " [" << units[i].toStdString() << "]";
+        }
+        file << ",";
+    }
+    file << "C+ [F/m],L+ [H/m],Z+ [Ohm],C- [F/m],L- [H/m],Z- [Ohm],Zdiff [Ohm],Zodd [Ohm],Zeven [Ohm],Zcomm [Ohm]" << std::endl;
+    file << std::setprecision(9);
+    QMutexLocker locker(&mutex);
+    for(auto &p : points) {
+        for(auto v : p.parameters) {
+            file << v << ",";
+        }
+        auto &r = p.result;
+        file << r.capacitanceP << "," << r.inductanceP << "," << r.impedanceP << ","
+             << r.capacitanceN << "," << r.inductanceN << "," << r.impedanceN << ","
+             << r.impedanceDiff << "," << r.modes.odd << "," << r.modes.even << "," << r.modes.common << std::endl;
+    }
+    file.close();
+    return true;
+}
+
+bool Sweep::prepare()
+{
+    if(running || points.empty()) {
+        return false;
+    }
+    // the thread of the last sweep has finished (it is not running anymore), release it
+    if(threaded) {
+        pthread_join(thread, nullptr);
+        threaded = false;
+    }
+    running = true;
+    abortRequested = false;
+    solvedCount = 0;
+    solvedOrder.clear();
+    auto nan = std::numeric_limits<double>::quiet_NaN();
+    for(auto &p : points) {
+        p.solved = false;
+        p.result = {nan, nan, nan, nan, nan, nan, nan, {nan, nan, nan, nan}};
+        p.solution = nullptr;
+    }
+    // the parameters are compared relative to their range when looking for the nearest neighbour
+    ranges = QVector<double>(points[0].parameters.size(), 0);
+    for(int i=0;i<ranges.size();i++) {
+        double min = points[0].parameters[i], max = min;
+        for(auto &p : points) {
+            min = std::min(min, p.parameters[i]);
+            max = std::max(max, p.parameters[i]);
+        }
+        ranges[i] = max > min ? max - min : 1.0;
+    }
+    return true;
+}
+
+bool Sweep::execute()
+{
+    QElapsedTimer timer;
+    timer.start();
+    int workers = std::min((int) points.size() - 1, threads);
+    keptSolutions = std::max(2, 2 * workers);
+    emit info("Sweeping "+QString::number(points.size())+" points");
+
+    // the first point starts from zero and gets all threads, all others start from it or a closer solved point
+    solve(0, threads);
+    if(workers > 0 && !abortRequested) {
+        threadsPerPoint = std::max(1, threads / workers);
+        nextPoint = 1;
+        emit info("Solving "+QString::number(workers)+" points at a time");
+        // the sweep thread is the first worker
+        std::vector<pthread_t> ids(workers - 1);
+        int started = 0;
+        for(auto &id : ids) {
+            if(pthread_create(&id, nullptr, workerTrampoline, this)) {
+                emit warning("Failed to start sweep worker thread");
+                break;
+            }
+            started++;
+        }
+        worker();
+        for(int i=0;i<started;i++) {
+            pthread_join(ids[i], nullptr);
+        }
+    }
+
+    {
+        QMutexLocker locker(&mutex);
+        for(auto &p : points) {
+            p.solution = nullptr;
+        }
+        solvedOrder.clear();
+    }
+    bool success = !abortRequested;
+    running = false;
+    if(success) {
+        emit info("Sweep complete, took "+QString::number(timer.elapsed() / 1000.0)+"s");
+        emit percentage(100);
+        emit sweepDone();
+    } else {
+        emit warning("Sweep aborted");
+        emit percentage(0);
+        emit sweepAborted();
+    }
+    return success;
+}
+
+void* Sweep::worker()
+{
+    while(!abortRequested) {
+        int i = nextPoint++;
+        if(i >= (int) points.size()) {
+            break;
+        }
+        solve(i, threadsPerPoint);
+    }
+    return nullptr;
+}
+
+bool Sweep::solve(int point, int threads)
+{
+    auto laplace = std::make_shared<Laplace>();
+    if(configure) {
+        configure(laplace.get());
+    }
+    laplace->setArea(topLeft, bottomRight);
+    laplace->setThreads(threads);
+    laplace->setMatrixExtraction(true);
+    QString prefix = "Point "+QString::number(point+1)+": ";
+    connect(laplace.get(), &Laplace::warning, this, [=](QString w) {
+        emit warning(prefix+w);
+    }, Qt::DirectConnection);
+    connect(laplace.get(), &Laplace::error, this, [=](QString e) {
+        emit error(prefix+e);
+    }, Qt::DirectConnection);
+
+    auto initial = nearestSolution(point);
+    laplace->setInitialSolution(initial.get());
+    {
+        QMutexLocker locker(&mutex);
+        if(abortRequested) {
+            return false;
+        }
+        active.push_back(laplace.get());
+    }
+    bool success = laplace->calculate(points[point].list);
+    initial = nullptr;
+
+    int done;
+    {
+        QMutexLocker locker(&mutex);
+        active.erase(std::find(active.begin(), active.end(), laplace.get()));
+        if(abortRequested) {
+            return false;
+        }
+        auto &p = points[point];
+        if(success) {
+            p.result = laplace->getLineParameters();
+            p.solved = true;
+            p.solution = laplace;
+            solvedOrder.push_back(point);
+            if(solvedOrder.size() > keptSolutions) {
+                // the first point stays, all points are close enough to start from it
+                auto oldest = solvedOrder.front() == 0 ? solvedOrder.begin() + 1 : solvedOrder.begin();
+                points[*oldest].solution = nullptr;
+                solvedOrder.erase(oldest);
+            }
+        }
+        done = ++solvedCount;
+    }
+    if(!success) {
+        emit warning(prefix+"calculation failed, no result");
+    }
+    emit percentage(done * 100 / points.size());
+    emit pointDone(point);
+    return success;
+}
+
+std::shared_ptr<Laplace> Sweep::nearestSolution(int point)
+{
+    QMutexLocker locker(&mutex);
+    std::shared_ptr<Laplace> nearest;
+    double minDistance = std::numeric_limits<double>::max();
+    for(auto i : solvedOrder) {
+        double distance = 0;
+        for(int j=0;j<ranges.size();j++) {
+            distance += pow((points[i].parameters[j] - points[point].parameters[j]) / ranges[j], 2.0);
+        }
+        if(distance < minDistance) {
+            minDistance = distance;
+            nearest = points[i].solution;
+        }
+    }
+    return nearest;
+}
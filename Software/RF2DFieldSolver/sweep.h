@@ -0,0 +1,108 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <QObject>
+#include <QPointF>
+#include <QMutex>
+#include <QVector>
+#include <QStringList>
+
+#include <pthread.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "elementlist.h"
+#include "laplace/laplace.h"
+
+// Solves many variations of the same problem (e.g. a parameter sweep of a scenario) on all cores. Every point
+// starts from the fields of its nearest solved neighbour, so all points must share the area and the conductors
+class Sweep : public QObject
+{
+    Q_OBJECT
+public:
+    explicit Sweep(QObject *parent = nullptr);
+    ~Sweep();
+
+    // applies the solver settings (grid, tolerance, ...) to the calculation of a point, the area, the threads and
+    // the conductor matrix are set by the sweep. Called from the worker threads
+    void setConfiguration(std::function<void(Laplace*)> configure);
+    void setArea(const QPointF &topLeft, const QPointF &bottomRight);
+    // total number of threads, shared by the points that are solved at the same time
+    void setThreads(int threads);
+    void setParameterNames(const QStringList &names, const QStringList &units);
+    // adds a point with its parameter values, takes ownership of the list
+    void addPoint(const QVector<double> &parameters, ElementList *list);
+    void clear();
+
+    bool start();
+    // same as start, but runs in the calling thread and returns once all points are done
+    bool run();
+    void abort();
+    bool isRunning() {return running;}
+
+    int getPoints() {return points.size();}
+    QVector<double> getParameters(int point) {return points[point].parameters;}
+    // NaN if the point has not been solved (yet)
+    Laplace::LineParameters getResult(int point);
+    // writes the parameters and C/L/Z of all points as CSV
+    bool exportTable(QString filename);
+
+signals:
+    void percentage(int percent);
+    void pointDone(int point);
+    void sweepDone();
+    void sweepAborted();
+    void info(QString info);
+    void warning(QString warning);
+    void error(QString error);
+
+private:
+    class Point {
+    public:
+        QVector<double> parameters;
+        ElementList *list;
+        bool solved;
+        Laplace::LineParameters result;
+        // the converged fields, kept as the initial value of the neighbouring points
+        std::shared_ptr<Laplace> solution;
+    };
+    bool prepare();
+    bool execute();
+    static void* executeTrampoline(void *ptr) {
+        ((Sweep*)ptr)->execute();
+        return nullptr;
+    }
+    // solves one point, starting from the nearest solved one
+    bool solve(int point, int threads);
+    std::shared_ptr<Laplace> nearestSolution(int point);
+    void* worker();
+    static void* workerTrampoline(void *ptr) {
+        return ((Sweep*)ptr)->worker();
+    }
+    std::vector<Point> points;
+    QStringList names, units;
+    std::function<void(Laplace*)> configure;
+    QPointF topLeft, bottomRight;
+    int threads;
+    int threadsPerPoint;
+    // only the solutions of the first and the last few points are kept, the fields need a lot of memory
+    unsigned int keptSolutions;
+    std::vector<int> solvedOrder;
+    int solvedCount;
+    // range of each parameter over all points, the distance to the neighbours is relative to it
+    QVector<double> ranges;
+    std::atomic<int> nextPoint;
+    // read by the worker threads without the mutex
+    std::atomic<bool> running;
+    std::atomic<bool> abortRequested;
+    // true while the sweep thread has not been joined, even after it finished
+    bool threaded;
+    // guards the points, the solutions and the running calculations
+    QMutex mutex;
+    std::vector<Laplace*> active;
+    pthread_t thread;
+};
+
+#endif // SWEEP_H
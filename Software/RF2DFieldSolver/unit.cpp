@@ -15,6 +15,9 @@ double Unit::FromString(QString string, QString unit, QString prefixes)
     // remove unit if present
     if(string.endsWith(unit, Qt::CaseInsensitive)) {
         string.chop(unit.size());
+        if(string.size() == 0) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
     }
     // check if last char is a valid prefix
     double factor = 1.0;